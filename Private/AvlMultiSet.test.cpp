@@ -0,0 +1,117 @@
+#include "Eco/AvlMultiSet.hpp"
+
+#include "Elements.test.hpp"
+
+#include "catch2/catch.hpp"
+
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+
+using namespace Eco;
+
+namespace {
+
+struct SequencedElement : AvlSetLink
+{
+	int value;
+	int sequence;
+
+	SequencedElement(int const value, int const sequence)
+		: value(value)
+		, sequence(sequence)
+	{
+	}
+};
+
+struct KeySelector
+{
+	int operator()(const SequencedElement& element) const
+	{
+		return element.value;
+	}
+};
+
+using Set = AvlMultiSet<SequencedElement, KeySelector>;
+
+} // namespace
+
+TEST_CASE("AvlMultiSet::Insert", "[AvlMultiSet][Container]")
+{
+	std::list<SequencedElement> storage;
+
+	auto rng = Catch::rng();
+	std::uniform_int_distribution<int> distribution(0, GENERATE(0, 10, 1000));
+
+	Set set;
+	std::multimap<int, int> std;
+
+	for (int i = 0; i < 2000; ++i)
+	{
+		int const value = distribution(rng);
+		set.Insert(&storage.emplace_back(value, i));
+		std.emplace(value, i);
+	}
+
+	REQUIRE(set.Size() == std.size());
+
+	// The multimap also keeps equivalent keys in insertion order.
+	REQUIRE(std::ranges::equal(std,
+		set | std::views::transform([](const SequencedElement& x) { return std::pair(x.value, x.sequence); }),
+		[](auto const& lhs, auto const& rhs) { return lhs.first == rhs.first && lhs.second == rhs.second; }));
+}
+
+TEST_CASE("AvlMultiSet::EqualRange", "[AvlMultiSet][Container]")
+{
+	std::list<SequencedElement> storage;
+
+	auto rng = Catch::rng();
+	std::uniform_int_distribution<int> distribution(0, 100);
+
+	Set set;
+	std::multimap<int, int> std;
+	std::vector<SequencedElement*> elements;
+
+	for (int i = 0; i < 1000; ++i)
+	{
+		int const value = distribution(rng);
+		SequencedElement* const element = &storage.emplace_back(value, i);
+		set.Insert(element);
+		std.emplace(value, i);
+		elements.push_back(element);
+	}
+
+	// Remove some elements to exercise rebalancing around duplicates.
+	for (size_t i = 0; i < elements.size(); i += 3)
+	{
+		SequencedElement* const element = elements[i];
+		set.Remove(element);
+
+		auto const range = std.equal_range(element->value);
+		std.erase(std::ranges::find(range.first, range.second, element->sequence, [](auto const& x) { return x.second; }));
+	}
+
+	for (int key = -1; key <= 101; ++key)
+	{
+		auto const stdRange = std.equal_range(key);
+		auto const range = set.EqualRange(key);
+
+		REQUIRE(set.Count(key) == std.count(key));
+		REQUIRE(set.CountEquivalent(static_cast<long>(key)) == std.count(key));
+		REQUIRE(std::ranges::equal(
+			std::ranges::subrange(stdRange.first, stdRange.second) | std::views::values,
+			range | std::views::transform([](const SequencedElement& x) { return x.sequence; })));
+		REQUIRE(std::ranges::equal(
+			range | std::views::transform([](const SequencedElement& x) { return x.sequence; }),
+			std::as_const(set).EqualRangeEquivalent(static_cast<long>(key)) | std::views::transform([](const SequencedElement& x) { return x.sequence; })));
+
+		const SequencedElement* const first = set.Find(key);
+		REQUIRE((first == nullptr) == (stdRange.first == stdRange.second));
+		if (first != nullptr)
+			REQUIRE(first->sequence == stdRange.first->second);
+
+		REQUIRE(set.UpperBound(key) == range.end());
+		REQUIRE(set.LowerBound(key) == range.begin());
+	}
+}
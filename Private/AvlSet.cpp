@@ -1,6 +1,9 @@
 #include "Eco/AvlSet.hpp"
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
 #include <utility>
 
 #include <cmath>
@@ -12,6 +15,24 @@ static_assert(sizeof(Hook) == sizeof(AvlSetLink));
 static_assert(CheckCompleteTaggedPointer<Ptr<Hook>>());
 
 
+// Child pointers are written using relaxed atomic stores during insertion and removal,
+// because ConcurrentAvlSet readers load them concurrently with these modifications.
+static void Store(Ptr<Hook>& slot, Ptr<Hook> const value)
+{
+	std::atomic_ref<Ptr<Hook>>(slot).store(value, std::memory_order_relaxed);
+}
+
+static void StorePtr(Ptr<Hook>& slot, Hook* const ptr)
+{
+	Store(slot, Ptr<Hook>(ptr, slot.Tag()));
+}
+
+static void StoreTag(Ptr<Hook>& slot, uintptr_t const tag)
+{
+	Store(slot, Ptr<Hook>(slot.Ptr(), tag));
+}
+
+
 static Hook* Leftmost(Hook* hook, uintptr_t const l)
 {
 	while (!hook->children[l].IsZero())
@@ -22,7 +43,7 @@ static Hook* Leftmost(Hook* hook, uintptr_t const l)
 }
 
 // Rotate from left to right.
-static void Rotate(Hook* const root, bool const l, bool const single, bool const rootBalance)
+static void Rotate(Hook* const root, bool const l, bool const single, bool const rootBalance, Augment* const augment)
 {
 	bool const r = !l;
 
@@ -32,19 +53,28 @@ static void Rotate(Hook* const root, bool const l, bool const single, bool const
 
 	bool const balance = !pivot->children[l].Tag() & single;
 
-	root->children[l].Set(child, balance);
-	root->children[r].SetTag(rootBalance);
+	Store(root->children[l], { child, balance });
+	StoreTag(root->children[r], rootBalance);
 	root->parent = pivot->children;
 
-	pivot->children[l].SetTag(0);
-	pivot->children[r].Set(root, balance);
+	StoreTag(pivot->children[l], 0);
+	Store(pivot->children[r], { root, balance });
 	pivot->parent = parent;
 
 	if (child != nullptr) child->parent = root->children;
-	parent[root != parent->Ptr()].SetPtr(pivot);
+	StorePtr(parent[root != parent->Ptr()], pivot);
+
+	// The root is now a child of the pivot.
+	if (augment != nullptr)
+	{
+		augment(root);
+		augment(pivot);
+	}
 }
 
-static void Rebalance(Ptr<Hook>* const root, Ptr<Hook>* node, bool l, bool const insert)
+// Retrace the heights from node towards the root, rotating where necessary.
+// Returns true if the change in height propagated all the way to the root.
+static bool Retrace(Ptr<Hook>* const root, Ptr<Hook>* node, bool l, bool const insert, Augment* const augment)
 {
 	while (node != root)
 	{
@@ -73,17 +103,17 @@ static void Rebalance(Ptr<Hook>* const root, Ptr<Hook>* node, bool l, bool const
 
 				// Rotate hook from r to l to allow the
 				// subsequent parent rotation to balance the parent.
-				Rotate(child, r, false, pivot->children[r].Tag());
+				Rotate(child, r, false, pivot->children[r].Tag(), augment);
 
 				newParent = pivot;
 			}
 
 			// Rotate parent from l to r to balance.
-			Rotate(parent, l, !doubleRotation, balance);
+			Rotate(parent, l, !doubleRotation, balance, augment);
 
 			// On insertion a single or double rotation always balances the tree.
 			// On removal a single rotation balances the tree if the pivot is balanced.
-			if (insert || doubleRotation == removalBalance) break;
+			if (insert || doubleRotation == removalBalance) return false;
 		}
 		else
 		{
@@ -92,18 +122,645 @@ static void Rebalance(Ptr<Hook>* const root, Ptr<Hook>* node, bool l, bool const
 			bool const balance = parent->children[r].Tag();
 
 			// The l side becomes 1, or cancels out with the r side.
-			parent->children[l].TagProxy() |= !balance;
+			StoreTag(parent->children[l], parent->children[l].Tag() | !balance);
 
 			// The r side either is already 0, or it becomes 0.
-			parent->children[r].SetTag(0);
+			StoreTag(parent->children[r], 0);
 
 			// If the r side is 1, the height of this subtree does not change.
-			if (balance == insert) break;
+			if (balance == insert) return false;
 		}
 
 		node = newParent->parent;
 		l = node->Ptr() != newParent;
 	}
+
+	return true;
+}
+
+// Recompute the augmentation of the hook owning children and each of its ancestors.
+static void Propagate(Ptr<Hook>* const root, Ptr<Hook>* children, Augment* const augment)
+{
+	while (children != root)
+	{
+		Hook* const hook = Eco_AVL_HOOK_FROM_CHILDREN(children);
+		augment(hook);
+		children = hook->parent;
+	}
+}
+
+// Rebalance the tree after the height of the l subtree of node changed.
+// Returns true if the change in height propagated all the way to the root.
+static bool Rebalance(Ptr<Hook>* const root, Ptr<Hook>* const node, bool const l, bool const insert, Augment* const augment)
+{
+	bool const propagated = Retrace(root, node, l, insert, augment);
+
+	// Unlike the height, the augmentation of every ancestor may have changed.
+	if (augment != nullptr)
+		Propagate(root, node, augment);
+
+	return propagated;
+}
+
+// Unlink a hook from the tree rooted at root.
+// Returns true if the height of the tree decreased.
+static bool Unlink(Ptr<Hook>* const root, Hook* const hook, Augment* const augment)
+{
+	Ptr<Hook>* const parent = hook->parent;
+	bool const l = parent->Ptr() != hook;
+
+	Ptr<Hook>* balanceHook = parent;
+	bool balanceL = l;
+
+	// If hook is not a leaf.
+	if (!hook->children[0].IsZero() || !hook->children[1].IsZero())
+	{
+		// Higher side of the tree on the left.
+		bool const succL = hook->children[1].Tag();
+		bool const succR = !succL;
+
+		Hook* const lChild = hook->children[succL].Ptr();
+		Hook* const rChild = hook->children[succR].Ptr();
+
+		// Find the in-order successor of hook on the higher side of the tree.
+		Hook* successor = lChild;
+
+		balanceHook = lChild->children;
+		balanceL = succL;
+
+		if (!lChild->children[succR].IsZero())
+		{
+			successor = Leftmost(lChild, succR);
+
+			Ptr<Hook>* const succParent = successor->parent;
+			Hook* const succChild = successor->children[succL].Ptr();
+
+			// Attach the successor's child to the successor's parent.
+			StorePtr(succParent[succR], succChild);
+			if (succChild != nullptr)
+				succChild->parent = succParent;
+
+			// Attach hook's direct child to the successor.
+			Store(successor->children[succL], { lChild, hook->children[succL].Tag() });
+			lChild->parent = successor->children;
+
+			balanceHook = successor->parent;
+			balanceL = succR;
+		}
+
+		StoreTag(successor->children[succL], hook->children[succL].Tag());
+
+		// Attach the hook's other child to the successor.
+		// Tag is known to be zero on the lower side.
+		Store(successor->children[succR], rChild);
+		if (rChild != nullptr)
+			rChild->parent = successor->children;
+
+		// Attach the successor to the removed hook's parent.
+		StorePtr(parent[l], successor);
+		successor->parent = parent;
+	}
+	else
+	{
+		StorePtr(parent[l], nullptr);
+	}
+
+	return Rebalance(root, balanceHook, balanceL, false, augment);
+}
+
+
+// Compute the height of a subtree by following its higher side.
+static uintptr_t Height(const Hook* hook)
+{
+	uintptr_t height = 0;
+	for (; hook != nullptr; ++height)
+	{
+		hook = hook->children[hook->children[1].Tag()].Ptr();
+	}
+	return height;
+}
+
+// Move a tree between root pointers.
+static void MoveRoot(Ptr<Hook>* const root, Ptr<Hook>* const src)
+{
+	*root = *src;
+	if (Hook* const hook = root->Ptr())
+		hook->parent = root;
+}
+
+// Detach a subtree into a separate root pointer.
+static void DetachSubtree(Ptr<Hook>* const root, Hook* const hook)
+{
+	*root = hook;
+	if (hook != nullptr)
+		hook->parent = root;
+}
+
+// Join two trees using a hook ordered between them.
+// The result is stored in root, which may alias lRoot or rRoot.
+// Returns the height of the resulting tree.
+static uintptr_t JoinTrees(Ptr<Hook>* const root,
+	Ptr<Hook>* const lRoot, uintptr_t const lHeight, Hook* const hook,
+	Ptr<Hook>* const rRoot, uintptr_t const rHeight, Augment* const augment)
+{
+	// Descend along the inner side of the higher tree.
+	bool const r = lHeight >= rHeight;
+	bool const l = !r;
+
+	Ptr<Hook>* const tRoot = r ? lRoot : rRoot;
+	uintptr_t const tHeight = r ? lHeight : rHeight;
+	Hook* const shorter = (r ? rRoot : lRoot)->Ptr();
+	uintptr_t const sHeight = r ? rHeight : lHeight;
+
+	Ptr<Hook>* parent = tRoot;
+	bool side = 0;
+
+	Hook* child = tRoot->Ptr();
+	uintptr_t height = tHeight;
+
+	// Find a subtree at most one level higher than the shorter tree.
+	while (height > sHeight + 1)
+	{
+		height -= 1 + child->children[l].Tag();
+		parent = child->children;
+		side = r;
+		child = child->children[r].Ptr();
+	}
+
+	hook->children[l].Set(child, height > sHeight);
+	hook->children[r] = shorter;
+
+	if (child != nullptr) child->parent = hook->children;
+	if (shorter != nullptr) shorter->parent = hook->children;
+
+	// Replace the subtree with the hook, making it one level higher.
+	hook->parent = parent;
+	parent[side].SetPtr(hook);
+
+	if (augment != nullptr)
+		augment(hook);
+
+	uintptr_t const joinHeight = tHeight + Rebalance(tRoot, parent, side, true, augment);
+
+	if (tRoot != root)
+		MoveRoot(root, tRoot);
+
+	return joinHeight;
+}
+
+// Join two trees where the hooks of lRoot are ordered before the hooks of rRoot.
+// The result is stored in root, which may alias lRoot or rRoot.
+// Returns the height of the resulting tree.
+static uintptr_t JoinTrees(Ptr<Hook>* const root,
+	Ptr<Hook>* const lRoot, uintptr_t const lHeight,
+	Ptr<Hook>* const rRoot, uintptr_t rHeight, Augment* const augment)
+{
+	if (rRoot->IsZero())
+	{
+		MoveRoot(root, lRoot);
+		return lHeight;
+	}
+
+	// Use the leftmost hook of the right tree to join the trees.
+	Hook* const hook = Leftmost(rRoot->Ptr(), 0);
+	rHeight -= Unlink(rRoot, hook, augment);
+
+	return JoinTrees(root, lRoot, lHeight, hook, rRoot, rHeight, augment);
+}
+
+namespace {
+
+// Position on a search path along with the height of the subtree at that position.
+struct Position
+{
+	Hook* hook;
+	Ptr<Hook>* children;
+	bool l;
+	uintptr_t height;
+};
+
+} // namespace
+
+// Find the position of a key hook in a tree of known height.
+static Position FindTree(Ptr<Hook>* const root, uintptr_t height,
+	const Core* const self, Hook* const key, Comparator* const comparator)
+{
+	Ptr<Hook>* children = root;
+	bool l = 0;
+
+	while (Hook* const hook = children[l].Ptr())
+	{
+		int const ordering = comparator(self, key, hook);
+		if (ordering == 0) return { hook, children, l, height };
+
+		children = hook->children;
+		l = ordering > 0;
+		height -= 1 + hook->children[!l].Tag();
+	}
+
+	return { nullptr, children, l, 0 };
+}
+
+// Split a tree along the search path ending at a position.
+// The hook at the position, if any, is excluded from both resulting trees.
+static void SplitTree(Ptr<Hook>* const root, Position const position,
+	Ptr<Hook>* const lRoot, uintptr_t& lHeight,
+	Ptr<Hook>* const rRoot, uintptr_t& rHeight, Augment* const augment)
+{
+	Ptr<Hook>* children = position.children;
+	bool l = position.l;
+	uintptr_t height = position.height;
+
+	*lRoot = nullptr;
+	*rRoot = nullptr;
+	lHeight = 0;
+	rHeight = 0;
+
+	if (Hook* const hook = position.hook)
+	{
+		DetachSubtree(lRoot, hook->children[0].Ptr());
+		lHeight = height - 1 - hook->children[1].Tag();
+
+		DetachSubtree(rRoot, hook->children[1].Ptr());
+		rHeight = height - 1 - hook->children[0].Tag();
+	}
+
+	// Walk up the search path joining each ancestor and its other subtree into
+	// either tree. Because the subtrees get higher on the way up, the total work
+	// is proportional to the height of the tree.
+	while (children != root)
+	{
+		Hook* const parent = Eco_AVL_HOOK_FROM_CHILDREN(children);
+		bool const r = !l;
+
+		// Derive the heights from the balance tags before the parent is relinked.
+		uintptr_t const sHeight = height - parent->children[l].Tag() + parent->children[r].Tag();
+		uintptr_t const pHeight = std::max(height, sHeight) + 1;
+
+		Ptr<Hook>* const next = parent->parent;
+		bool const nextL = next->Ptr() != parent;
+
+		Ptr<Hook> sRoot;
+		DetachSubtree(&sRoot, parent->children[r].Ptr());
+
+		if (r)
+		{
+			// The search went left: the parent and its right subtree are ordered after the key.
+			rHeight = JoinTrees(rRoot, rRoot, rHeight, parent, &sRoot, sHeight, augment);
+		}
+		else
+		{
+			// The search went right: the parent and its left subtree are ordered before the key.
+			lHeight = JoinTrees(lRoot, &sRoot, sHeight, parent, lRoot, lHeight, augment);
+		}
+
+		children = next;
+		l = nextL;
+		height = pHeight;
+	}
+}
+
+// Position of a hook within its tree.
+static Position HookPosition(Hook* const hook)
+{
+	return { hook, hook->parent, hook->parent->Ptr() != hook, Height(hook) };
+}
+
+// Join two trees using an optional hook ordered between them.
+static uintptr_t JoinTreesOptional(Ptr<Hook>* const root,
+	Ptr<Hook>* const lRoot, uintptr_t const lHeight, Hook* const hook,
+	Ptr<Hook>* const rRoot, uintptr_t const rHeight, Augment* const augment)
+{
+	return hook != nullptr
+		? JoinTrees(root, lRoot, lHeight, hook, rRoot, rHeight, augment)
+		: JoinTrees(root, lRoot, lHeight, rRoot, rHeight, augment);
+}
+
+// Union of the tree in root and the subtree of hook, which is consumed.
+// Hooks of root matching those of the subtree are moved into xRoot.
+// Returns the height of the resulting tree.
+static uintptr_t UnionTrees(Ptr<Hook>* const root, uintptr_t const height,
+	Hook* const hook, uintptr_t const tHeight,
+	Ptr<Hook>* const xRoot, uintptr_t& xHeight, size_t& count,
+	const Core* const self, Comparator* const comparator, Augment* const augment)
+{
+	if (hook == nullptr || root->IsZero())
+	{
+		*xRoot = nullptr;
+		xHeight = 0;
+
+		if (hook == nullptr) return height;
+
+		DetachSubtree(root, hook);
+		return tHeight;
+	}
+
+	Hook* const lChild = hook->children[0].Ptr();
+	Hook* const rChild = hook->children[1].Ptr();
+	uintptr_t const lChildHeight = tHeight - 1 - hook->children[1].Tag();
+	uintptr_t const rChildHeight = tHeight - 1 - hook->children[0].Tag();
+
+	Position const position = FindTree(root, height, self, hook, comparator);
+
+	Ptr<Hook> lRoot;
+	Ptr<Hook> rRoot;
+	uintptr_t lHeight;
+	uintptr_t rHeight;
+	SplitTree(root, position, &lRoot, lHeight, &rRoot, rHeight, augment);
+
+	Ptr<Hook> lxRoot;
+	Ptr<Hook> rxRoot;
+	uintptr_t lxHeight;
+	uintptr_t rxHeight;
+	lHeight = UnionTrees(&lRoot, lHeight, lChild, lChildHeight, &lxRoot, lxHeight, count, self, comparator, augment);
+	rHeight = UnionTrees(&rRoot, rHeight, rChild, rChildHeight, &rxRoot, rxHeight, count, self, comparator, augment);
+
+	count += position.hook != nullptr;
+	xHeight = JoinTreesOptional(xRoot, &lxRoot, lxHeight, position.hook, &rxRoot, rxHeight, augment);
+	return JoinTrees(root, &lRoot, lHeight, hook, &rRoot, rHeight, augment);
+}
+
+// Partition the tree in root by the presence of its keys in the subtree of hook.
+// Hooks whose presence differs from contained are moved into xRoot.
+// Returns the height of the resulting tree.
+static uintptr_t FilterTrees(Ptr<Hook>* const root, uintptr_t const height,
+	Hook* const hook, bool const contained,
+	Ptr<Hook>* const xRoot, uintptr_t& xHeight, size_t& count,
+	const Core* const self, Comparator* const comparator, Augment* const augment)
+{
+	if (hook == nullptr || root->IsZero())
+	{
+		*xRoot = nullptr;
+		xHeight = 0;
+
+		if (hook != nullptr || !contained) return height;
+
+		MoveRoot(xRoot, root);
+		*root = nullptr;
+		xHeight = height;
+		return 0;
+	}
+
+	Position const position = FindTree(root, height, self, hook, comparator);
+
+	Ptr<Hook> lRoot;
+	Ptr<Hook> rRoot;
+	uintptr_t lHeight;
+	uintptr_t rHeight;
+	SplitTree(root, position, &lRoot, lHeight, &rRoot, rHeight, augment);
+
+	Ptr<Hook> lxRoot;
+	Ptr<Hook> rxRoot;
+	uintptr_t lxHeight;
+	uintptr_t rxHeight;
+	lHeight = FilterTrees(&lRoot, lHeight, hook->children[0].Ptr(), contained, &lxRoot, lxHeight, count, self, comparator, augment);
+	rHeight = FilterTrees(&rRoot, rHeight, hook->children[1].Ptr(), contained, &rxRoot, rxHeight, count, self, comparator, augment);
+
+	Hook* const match = position.hook;
+	count += match != nullptr;
+
+	xHeight = JoinTreesOptional(xRoot, &lxRoot, lxHeight, contained ? nullptr : match, &rxRoot, rxHeight, augment);
+	return JoinTreesOptional(root, &lRoot, lHeight, contained ? match : nullptr, &rRoot, rHeight, augment);
+}
+
+namespace {
+
+// Limits the number of pieces a bulk operation is divided into.
+constexpr uintptr_t MaxBulkDepth = 6;
+
+// Subtrees of the traversed tree lower than this are not divided any further.
+constexpr uintptr_t MinBulkHeight = 12;
+
+struct BulkPiece
+{
+	// Subtree of the traversed tree.
+	Hook* tHook;
+	uintptr_t tHeight;
+
+	// Piece of the split tree, which is replaced by the result.
+	Ptr<Hook> root;
+	uintptr_t height;
+
+	// Hooks moved out of the result.
+	Ptr<Hook> xRoot;
+	uintptr_t xHeight;
+
+	size_t count;
+};
+
+// A bulk operation divided into independent pieces along the top levels of the
+// traversed tree. The split tree is split at each of the dividing hooks, after
+// which each piece can be processed in parallel and finally joined back together.
+struct Bulk
+{
+	const Core* self;
+	Comparator* comparator;
+	Augment* augment;
+
+	// Union if true, otherwise a filter keeping hooks with this presence.
+	bool merge;
+	bool contained;
+
+	size_t pieceCount = 0;
+	BulkPiece pieces[size_t(1) << MaxBulkDepth];
+
+	// Dividing hooks of the traversed tree and their matches in the split tree.
+	Hook* pivots[(size_t(1) << MaxBulkDepth) - 1];
+	Hook* matches[(size_t(1) << MaxBulkDepth) - 1];
+};
+
+} // namespace
+
+static void DivideBulk(Bulk& bulk, Hook* const hook, uintptr_t const height, uintptr_t const depth)
+{
+	if (depth == 0 || hook == nullptr)
+	{
+		BulkPiece& piece = bulk.pieces[bulk.pieceCount++];
+		piece.tHook = hook;
+		piece.tHeight = height;
+		return;
+	}
+
+	DivideBulk(bulk, hook->children[0].Ptr(), height - 1 - hook->children[1].Tag(), depth - 1);
+	bulk.pivots[bulk.pieceCount - 1] = hook;
+	DivideBulk(bulk, hook->children[1].Ptr(), height - 1 - hook->children[0].Tag(), depth - 1);
+}
+
+static void RunBulkPiece(void* const context, size_t const index)
+{
+	Bulk& bulk = *static_cast<Bulk*>(context);
+	BulkPiece& piece = bulk.pieces[index];
+
+	piece.count = 0;
+	piece.height = bulk.merge
+		? UnionTrees(&piece.root, piece.height, piece.tHook, piece.tHeight,
+			&piece.xRoot, piece.xHeight, piece.count, bulk.self, bulk.comparator, bulk.augment)
+		: FilterTrees(&piece.root, piece.height, piece.tHook, bulk.contained,
+			&piece.xRoot, piece.xHeight, piece.count, bulk.self, bulk.comparator, bulk.augment);
+}
+
+// Run a bulk operation traversing the tree in tRoot and splitting the tree in sRoot.
+// The resulting trees are stored in root and xRoot, which may alias sRoot.
+// Returns the number of matching keys.
+static size_t RunBulk(Bulk& bulk, const Ptr<Hook>* const tRoot, Ptr<Hook>* const sRoot,
+	Ptr<Hook>* const root, Ptr<Hook>* const xRoot, const Private::ExecutorRef* const executor)
+{
+	uintptr_t const tHeight = Height(tRoot->Ptr());
+
+	uintptr_t depth = 0;
+	if (executor != nullptr && tHeight > MinBulkHeight)
+	{
+		// Aim for a few pieces per thread so that uneven pieces even out.
+		depth = std::min<uintptr_t>({ MaxBulkDepth,
+			static_cast<uintptr_t>(std::bit_width(executor->Concurrency())) + 2,
+			tHeight - MinBulkHeight });
+	}
+
+	DivideBulk(bulk, tRoot->Ptr(), tHeight, depth);
+
+	// Split the split tree at each pivot from left to right.
+	Ptr<Hook> rest;
+	MoveRoot(&rest, sRoot);
+	uintptr_t restHeight = Height(rest.Ptr());
+
+	for (size_t i = 0; i + 1 < bulk.pieceCount; ++i)
+	{
+		BulkPiece& piece = bulk.pieces[i];
+		Position const position = FindTree(&rest, restHeight, bulk.self, bulk.pivots[i], bulk.comparator);
+
+		Ptr<Hook> rRoot;
+		SplitTree(&rest, position, &piece.root, piece.height, &rRoot, restHeight, bulk.augment);
+		MoveRoot(&rest, &rRoot);
+
+		bulk.matches[i] = position.hook;
+	}
+
+	BulkPiece& last = bulk.pieces[bulk.pieceCount - 1];
+	MoveRoot(&last.root, &rest);
+	last.height = restHeight;
+
+	if (executor != nullptr)
+	{
+		executor->Run(bulk.pieceCount, RunBulkPiece, &bulk);
+	}
+	else
+	{
+		RunBulkPiece(&bulk, 0);
+	}
+
+	// Join the results back together, along with the pivots and their matches.
+	MoveRoot(root, &bulk.pieces[0].root);
+	MoveRoot(xRoot, &bulk.pieces[0].xRoot);
+	uintptr_t height = bulk.pieces[0].height;
+	uintptr_t xHeight = bulk.pieces[0].xHeight;
+	size_t count = bulk.pieces[0].count;
+
+	for (size_t i = 1; i < bulk.pieceCount; ++i)
+	{
+		BulkPiece& piece = bulk.pieces[i];
+		Hook* const pivot = bulk.pivots[i - 1];
+		Hook* const match = bulk.matches[i - 1];
+
+		Hook* const kept = bulk.merge ? pivot : bulk.contained ? match : nullptr;
+		Hook* const moved = bulk.merge || !bulk.contained ? match : nullptr;
+
+		height = JoinTreesOptional(root, root, height, kept, &piece.root, piece.height, bulk.augment);
+		xHeight = JoinTreesOptional(xRoot, xRoot, xHeight, moved, &piece.xRoot, piece.xHeight, bulk.augment);
+		count += piece.count + (match != nullptr);
+	}
+
+	return count;
+}
+
+#if Eco_CONFIG_LINK_DEBUG
+// Transfer the ownership of all hooks in a tree to another container.
+static void Relink(Ptr<Hook>* const root, LinkContainer& src, LinkContainer& dst)
+{
+	for (Ptr<Hook>* children = IteratorBegin(root); children != root; children = IteratorAdvance(children, 0))
+	{
+		Hook* const hook = Eco_AVL_HOOK_FROM_CHILDREN(children);
+		LinkRemove(*hook, src);
+		LinkInsert(*hook, dst);
+	}
+}
+#endif
+
+// Link the hooks of a tree to their in-order predecessors through children[0],
+// continuing the chain ending at tail, and reset the root.
+// Returns the new tail of the chain.
+static Hook* ChainTree(Ptr<Hook>* const root, Hook* tail, size_t& count)
+{
+	if (root->IsZero())
+		return tail;
+
+	// The left subtree of a hook is visited before the hook itself,
+	// so overwriting children[0] does not disturb the traversal.
+	for (Hook* hook = Leftmost(root->Ptr(), 0); hook != nullptr;)
+	{
+		Ptr<Hook>* const next = IteratorAdvance(hook->children, 0);
+
+		hook->children[0] = tail;
+		tail = hook;
+		++count;
+
+		hook = next != root ? Eco_AVL_HOOK_FROM_CHILDREN(next) : nullptr;
+	}
+
+	*root = nullptr;
+	return tail;
+}
+
+// Turn a chain of hooks linked through children[0] into a circular list.
+static Private::List_::Hook* ChainToList(Hook* const tail)
+{
+	if (tail == nullptr)
+		return nullptr;
+
+	// Walk the chain backwards turning it into a circular list.
+	// It is important that each child pointer is overwritten to reset tags.
+	Hook* head = nullptr;
+	for (Hook* hook = tail; hook != nullptr;)
+	{
+		Hook* const prev = hook->children[0].Ptr();
+
+		hook->children[0] = head;
+		hook->children[1] = prev;
+
+		head = hook;
+		hook = prev;
+	}
+
+	head->children[1] = tail;
+	tail->children[0] = head;
+
+	return reinterpret_cast<Private::List_::Hook*>(head);
+}
+
+// Build a perfectly balanced subtree out of the next size hooks of a list.
+static Hook* BuildSubtree(Private::List_::Hook*& list, size_t const size, Augment* const augment)
+{
+	if (size == 0) return nullptr;
+
+	// The right subtree receives the extra hook when size is even.
+	size_t const lSize = (size - 1) / 2;
+	size_t const rSize = size - 1 - lSize;
+
+	Hook* const lChild = BuildSubtree(list, lSize, augment);
+	Hook* const hook = reinterpret_cast<Hook*>(list);
+	list = list->siblings[0];
+	Hook* const rChild = BuildSubtree(list, rSize, augment);
+
+	// A perfectly balanced subtree of size n has height bit_width(n).
+	hook->children[0] = lChild;
+	hook->children[1].Set(rChild, std::bit_width(rSize) > std::bit_width(lSize));
+
+	if (lChild != nullptr) lChild->parent = hook->children;
+	if (rChild != nullptr) rChild->parent = hook->children;
+
+	if (augment != nullptr)
+		augment(hook);
+
+	return hook;
 }
 
 static bool Invariant(const Core* const self)
@@ -168,95 +825,99 @@ static bool Invariant(const Core* const self)
 		}
 	}
 
-	return size == self->m_size.Value;
+	return self->m_size.Value == Core::UnknownSize || size == self->m_size.Value;
 }
 
 
-void Core::Insert(Hook* const hook, Ptr<Ptr<Hook>> const parentAndSide)
+size_t Core::CountSize() const
 {
-	LinkInsert(*hook, *this);
+	Ptr<Hook>* const root = const_cast<Ptr<Hook>*>(&m_root.Value);
 
-	++m_size.Value;
+	size_t size = 0;
+	for (Ptr<Hook>* children = IteratorBegin(root); children != root; children = IteratorAdvance(children, 0))
+		++size;
+	return size;
+}
 
-	Ptr<Hook>* const parent = parentAndSide.Ptr();
-	bool const l = parentAndSide.Tag();
+Core::HintResult Core::FindHint(Hook* const next)
+{
+	if (next == nullptr)
+	{
+		// Insert after the last hook.
+		Hook* const root = m_root->Ptr();
+		if (root == nullptr) return { nullptr, { &m_root.Value, 0 } };
 
-	hook->children[0] = nullptr;
-	hook->children[1] = nullptr;
-	hook->parent = parent;
-	parent[l].SetPtr(hook);
+		Hook* const prev = Leftmost(root, 1);
+		return { prev, { prev->children, 1 } };
+	}
 
-	Rebalance(&m_root.Value, parent, l, true);
+	// The predecessor is the rightmost hook of the left subtree, if any.
+	if (Hook* const child = next->children[0].Ptr())
+	{
+		Hook* const prev = Leftmost(child, 1);
+		return { prev, { prev->children, 1 } };
+	}
 
-	Eco_AssertSlow(Invariant(this));
+	// Otherwise it is the closest ancestor with next in its right subtree.
+	Hook* prev = nullptr;
+	for (Hook* hook = next; hook->parent != &m_root.Value;)
+	{
+		Hook* const parent = Eco_AVL_HOOK_FROM_CHILDREN(hook->parent);
+		if (parent->children[1].Ptr() == hook)
+		{
+			prev = parent;
+			break;
+		}
+		hook = parent;
+	}
+
+	return { prev, { next->children, 0 } };
 }
 
-void Core::Remove(Hook* const hook)
+void Core::Insert(Hook* const hook, Ptr<Ptr<Hook>> const parentAndSide, Augment* const augment)
 {
-	LinkRemove(*hook, *this);
-
-	--m_size.Value;
-
-	Ptr<Hook>* const parent = hook->parent;
-	bool const l = parent->Ptr() != hook;
-
-	Ptr<Hook>* balanceHook = parent;
-	bool balanceL = l;
+	LinkInsert(*hook, *this);
 
-	// If hook is not a leaf.
-	if (!hook->children[0].IsZero() || !hook->children[1].IsZero())
-	{
-		// Higher side of the tree on the left.
-		bool const succL = hook->children[1].Tag();
-		bool const succR = !succL;
+	if (m_size.Value != UnknownSize)
+		++m_size.Value;
 
-		Hook* const lChild = hook->children[succL].Ptr();
-		Hook* const rChild = hook->children[succR].Ptr();
+	Ptr<Hook>* const parent = parentAndSide.Ptr();
+	bool const l = parentAndSide.Tag();
 
-		// Find the in-order successor of hook on the higher side of the tree.
-		Hook* successor = lChild;
+	Store(hook->children[0], nullptr);
+	Store(hook->children[1], nullptr);
+	hook->parent = parent;
+	StorePtr(parent[l], hook);
 
-		balanceHook = lChild->children;
-		balanceL = succL;
+	if (augment != nullptr)
+		augment(hook);
 
-		if (!lChild->children[succR].IsZero())
-		{
-			successor = Leftmost(lChild, succR);
+	Rebalance(&m_root.Value, parent, l, true, augment);
 
-			Ptr<Hook>* const succParent = successor->parent;
-			Hook* const succChild = successor->children[succL].Ptr();
+	Eco_AssertSlow(Invariant(this));
+}
 
-			// Attach the successor's child to the successor's parent.
-			succParent[succR].SetPtr(succChild);
-			if (succChild != nullptr)
-				succChild->parent = succParent;
+void Core::Remove(Hook* const hook, Augment* const augment)
+{
+	LinkRemove(*hook, *this);
 
-			// Attach hook's direct child to the successor.
-			successor->children[succL].Set(lChild, hook->children[succL].Tag());
-			lChild->parent = successor->children;
+	if (m_size.Value != UnknownSize)
+		--m_size.Value;
 
-			balanceHook = successor->parent;
-			balanceL = succR;
-		}
+	Unlink(&m_root.Value, hook, augment);
 
-		successor->children[succL].SetTag(hook->children[succL].Tag());
+	Eco_AssertSlow(Invariant(this));
+}
 
-		// Attach the hook's other child to the successor.
-		// Tag is known to be zero on the lower side.
-		successor->children[succR] = rChild;
-		if (rChild != nullptr)
-			rChild->parent = successor->children;
+void Core::Relocate(Hook* const hook, Hook* const newHook)
+{
+	LinkRelocate(*hook, *newHook, *this);
 
-		// Attach the successor to the removed hook's parent.
-		parent[l].SetPtr(successor);
-		successor->parent = parent;
-	}
-	else
-	{
-		parent[l].SetPtr(nullptr);
-	}
+	Ptr<Hook>* const parent = newHook->parent;
+	parent[parent[0].Ptr() != hook].SetPtr(newHook);
 
-	Rebalance(&m_root.Value, balanceHook, balanceL, false);
+	for (Ptr<Hook> const child : newHook->children)
+		if (!child.IsZero()) child.Ptr()->parent = newHook->children;
 
 	Eco_AssertSlow(Invariant(this));
 }
@@ -278,73 +939,256 @@ void Core::Clear()
 				Hook* const hook = Eco_AVL_HOOK_FROM_CHILDREN(children);
 
 				children = std::exchange(hook->parent, nullptr);
-				children[hook != children[0].Ptr()] = nullptr;
+				Store(children[hook != children[0].Ptr()], nullptr);
 
 				LinkRemove(*hook, *this);
 			}
 		}
 
-		m_root = nullptr;
+		Store(m_root.Value, nullptr);
 		m_size = 0;
 	}
 
 	Eco_AssertSlow(Invariant(this));
 }
 
+void Core::Build(List_::Hook* const list, size_t const size, Augment* const augment)
+{
+	Eco_Assert(m_root->IsZero());
+
+	List_::Hook* next = list;
+	if (Hook* const root = BuildSubtree(next, size, augment))
+	{
+		root->parent = &m_root.Value;
+		m_root = root;
+	}
+	m_size = size;
+
+	Eco_AssertSlow(Invariant(this));
+}
+
 Private::List_::Hook* Core::Flatten()
 {
-	Hook* root = m_root->Ptr();
+	size_t count = 0;
+	Hook* const tail = ChainTree(&m_root.Value, nullptr, count);
+
+	m_size = 0;
+
+	Eco_AssertSlow(Invariant(this));
+
+	return ChainToList(tail);
+}
 
-	if (root != nullptr)
+Private::List_::Hook* Core::RemoveRange(Ptr<Hook>* const first, Ptr<Hook>* const last, Core& other, Augment* const augment)
+{
+	Eco_Assert(other.m_root->IsZero());
+
+	if (first == last)
 	{
-		m_root = nullptr;
-		m_size = 0;
+		other.m_size = 0;
+		return nullptr;
+	}
 
-		auto const FlattenSide = [](Hook* node, bool const l) -> Hook*
-		{
-			bool const r = !l;
+	Hook* const hook = Eco_AVL_HOOK_FROM_CHILDREN(first);
+	Hook* const next = last != &m_root.Value ? Eco_AVL_HOOK_FROM_CHILDREN(last) : nullptr;
 
-			while (node->children[l].IsZero())
-			{
-				// Rotate the whole left subtree right to left turning it into a list.
-				// It is important that each non-zero child pointer is overwritten to reset tags.
+	Ptr<Hook> lRoot;
+	Ptr<Hook> rRoot;
+	uintptr_t lHeight;
+	uintptr_t rHeight;
 
-				Hook* const tail = node->children[l].Ptr();
-				Hook* head = tail;
+	SplitTree(&m_root.Value, HookPosition(hook), &lRoot, lHeight, &rRoot, rHeight, augment);
 
-				while (!head->children[r].IsZero())
-				{
-					Hook* const pivot = head->children[r].Ptr();
+	// The hooks after the first removed hook and before the next hook are removed.
+	Ptr<Hook> mRoot;
+	if (next != nullptr)
+	{
+		Ptr<Hook> nRoot;
+		uintptr_t mHeight;
+		uintptr_t nHeight;
 
-					pivot->children[l] = head;
-					head->children[r] = pivot;
+		SplitTree(&rRoot, HookPosition(next), &mRoot, mHeight, &nRoot, nHeight, augment);
+		JoinTrees(&lRoot, &lRoot, lHeight, next, &nRoot, nHeight, augment);
+	}
+	else
+	{
+		MoveRoot(&mRoot, &rRoot);
+	}
 
-					head = pivot;
-				}
+	MoveRoot(&m_root.Value, &lRoot);
 
-				node->children[l] = head;
-				head->children[r] = node;
+#if Eco_CONFIG_LINK_DEBUG
+	Relink(&mRoot, *this, other);
+	LinkRemove(*hook, *this);
+	LinkInsert(*hook, other);
+#endif
 
-				node = tail;
-			}
+	hook->children[0] = nullptr;
+	size_t count = 1;
+	Hook* const tail = ChainTree(&mRoot, hook, count);
 
-			return node;
-		};
+	if (m_size.Value != UnknownSize)
+		m_size.Value -= count;
+	other.m_size = count;
+
+	Eco_AssertSlow(Invariant(this));
 
-		Hook* const head = FlattenSide(root, 0);
-		Hook* const tail = FlattenSide(root, 1);
+	return ChainToList(tail);
+}
+
+void Core::Split(Hook* const hook, Ptr<Ptr<Hook>> const parentAndSide, Core& other, Augment* const augment)
+{
+	Eco_Assert(other.m_root->IsZero());
 
-		head->children[0] = tail;
-		tail->children[1] = head;
+	Ptr<Hook>* children = parentAndSide.Ptr();
+	bool l = parentAndSide.Tag();
 
-		root = head;
+	if (hook != nullptr)
+	{
+		children = hook->parent;
+		l = children->Ptr() != hook;
 	}
 
+	Ptr<Hook> lRoot;
+	Ptr<Hook> rRoot;
+	uintptr_t lHeight;
+	uintptr_t rHeight;
+
+	SplitTree(&m_root.Value, { hook, children, l, Height(hook) }, &lRoot, lHeight, &rRoot, rHeight, augment);
+
+	// The hook itself is ordered first in the right tree.
+	if (hook != nullptr)
+	{
+		Ptr<Hook> empty = nullptr;
+		JoinTrees(&rRoot, &empty, 0, hook, &rRoot, rHeight, augment);
+	}
+
+	MoveRoot(&m_root.Value, &lRoot);
+	MoveRoot(&other.m_root.Value, &rRoot);
+
+#if Eco_CONFIG_LINK_DEBUG
+	Relink(&other.m_root.Value, *this, other);
+#endif
+
+	// Counting either tree would take linear time, so both are counted when first needed.
+	m_size = UnknownSize;
+	other.m_size = UnknownSize;
+
+	Eco_AssertSlow(Invariant(this));
+	Eco_AssertSlow(Invariant(&other));
+}
+
+void Core::Join(Core& other, bool const after, Augment* const augment)
+{
+	Ptr<Hook>* const lRoot = after ? &m_root.Value : &other.m_root.Value;
+	Ptr<Hook>* const rRoot = after ? &other.m_root.Value : &m_root.Value;
+
+#if Eco_CONFIG_LINK_DEBUG
+	Relink(&other.m_root.Value, other, *this);
+#endif
+
+	JoinTrees(&m_root.Value, lRoot, Height(lRoot->Ptr()), rRoot, Height(rRoot->Ptr()), augment);
+
+	other.m_root = nullptr;
+
+	size_t const otherSize = std::exchange(other.m_size.Value, 0);
+	m_size = m_size.Value != UnknownSize && otherSize != UnknownSize
+		? m_size.Value + otherSize
+		: UnknownSize;
+
+	Eco_AssertSlow(Invariant(this));
+	Eco_AssertSlow(Invariant(&other));
+}
+
+void Core::Union(Core& other, Comparator* const comparator, Augment* const augment, const Private::ExecutorRef* const executor)
+{
+#if Eco_CONFIG_LINK_DEBUG
+	Relink(&other.m_root.Value, other, *this);
+#endif
+
+	Bulk bulk;
+	bulk.self = this;
+	bulk.comparator = comparator;
+	bulk.augment = augment;
+	bulk.merge = true;
+	bulk.contained = true;
+
+	size_t const count = RunBulk(bulk, &m_root.Value, &other.m_root.Value,
+		&m_root.Value, &other.m_root.Value, executor);
+
+#if Eco_CONFIG_LINK_DEBUG
+	Relink(&other.m_root.Value, *this, other);
+#endif
+
+	m_size = m_size.Value != UnknownSize && other.m_size.Value != UnknownSize
+		? m_size.Value + other.m_size.Value - count
+		: UnknownSize;
+	other.m_size = count;
+
 	Eco_AssertSlow(Invariant(this));
+	Eco_AssertSlow(Invariant(&other));
+}
+
+static void DivideTree(Core::Division& division, Hook* const hook, uintptr_t const depth)
+{
+	if (depth == 0 || hook == nullptr)
+	{
+		division.subtrees[division.count++] = hook;
+		return;
+	}
+
+	DivideTree(division, hook->children[0].Ptr(), depth - 1);
+	division.pivots[division.count - 1] = hook;
+	DivideTree(division, hook->children[1].Ptr(), depth - 1);
+}
+
+void Core::Divide(Division& division, const Private::ExecutorRef& executor) const
+{
+	Hook* const root = m_root->Ptr();
+	uintptr_t const height = Height(root);
 
-	return reinterpret_cast<List_::Hook*>(root);
+	// Aim for a few subtrees per thread so that uneven subtrees even out.
+	uintptr_t depth = 0;
+	if (height > MinBulkHeight)
+	{
+		depth = std::min<uintptr_t>({ MaxDivideDepth,
+			static_cast<uintptr_t>(std::bit_width(executor.Concurrency())) + 2,
+			height - MinBulkHeight });
+	}
+
+	division.count = 0;
+	DivideTree(division, root, depth);
 }
 
+void Core::Filter(const Core& other, bool const contained, Core& removed,
+	Comparator* const comparator, Augment* const augment, const Private::ExecutorRef* const executor)
+{
+	Eco_Assert(removed.m_root->IsZero());
+
+	Bulk bulk;
+	bulk.self = this;
+	bulk.comparator = comparator;
+	bulk.augment = augment;
+	bulk.merge = false;
+	bulk.contained = contained;
+
+	size_t const count = RunBulk(bulk, &other.m_root.Value, &m_root.Value,
+		&m_root.Value, &removed.m_root.Value, executor);
+
+#if Eco_CONFIG_LINK_DEBUG
+	Relink(&removed.m_root.Value, *this, removed);
+#endif
+
+	size_t const size = m_size.Value;
+	size_t const rest = size != UnknownSize ? size - count : UnknownSize;
+	m_size = contained ? count : rest;
+	removed.m_size = contained ? rest : count;
+
+	Eco_AssertSlow(Invariant(this));
+	Eco_AssertSlow(Invariant(&removed));
+}
+
+
 
 Ptr<Hook>* Private::AvlSet_::IteratorBegin(Ptr<Hook>* const root)
 {
@@ -361,8 +1205,8 @@ Ptr<Hook>* Private::AvlSet_::IteratorAdvance(Ptr<Hook>* const children, uintptr_
 
 	Hook* hook = Eco_AVL_HOOK_FROM_CHILDREN(children);
 
-	// Iterate through ancestors until the branch where the hook is the left child.
-	while (hook != hook->parent->Ptr()) hook = Eco_AVL_HOOK_FROM_CHILDREN(hook->parent);
+	// Iterate through ancestors until the branch where the hook is the l child.
+	while (hook != hook->parent[l].Ptr()) hook = Eco_AVL_HOOK_FROM_CHILDREN(hook->parent);
 
 	return hook->parent;
 }
@@ -1,10 +1,18 @@
 #include "Eco/AvlSet.hpp"
 
 #include "Elements.test.hpp"
+#include "Executors.test.hpp"
 
 #include "catch2/catch.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
 #include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 using namespace Eco;
 
@@ -20,6 +28,200 @@ struct KeySelector
 
 using Set = AvlSet<Element, KeySelector>;
 
+struct AugmentedElement : AvlSetLink
+{
+	int value;
+
+	// Polynomial hash of the subtree, which depends on the order of the elements.
+	struct Hash
+	{
+		uint64_t value;
+		uint64_t power;
+
+		bool operator==(const Hash&) const = default;
+	} hash;
+
+	AugmentedElement(int const value)
+		: value(value)
+	{
+	}
+};
+
+struct AugmentedKeySelector
+{
+	int operator()(const AugmentedElement& element) const
+	{
+		return element.value;
+	}
+};
+
+struct HashAugment
+{
+	using ValueType = AugmentedElement::Hash;
+
+	static ValueType Identity()
+	{
+		return { 0, 1 };
+	}
+
+	static ValueType Value(const AugmentedElement& element)
+	{
+		return { static_cast<uint64_t>(element.value), 31 };
+	}
+
+	static ValueType Combine(const ValueType& lhs, const ValueType& rhs)
+	{
+		return { lhs.value * rhs.power + rhs.value, lhs.power * rhs.power };
+	}
+
+	static ValueType& Aggregate(AugmentedElement& element)
+	{
+		return element.hash;
+	}
+};
+
+using AugmentedSet = AvlSet<AugmentedElement, AugmentedKeySelector, std::compare_three_way, HashAugment>;
+
+struct WeightedElement : AvlSetLink
+{
+	int value;
+	double weight;
+
+	// Sum of the weights of the subtree.
+	double weightSum;
+
+	WeightedElement(int const value, double const weight)
+		: value(value)
+		, weight(weight)
+	{
+	}
+};
+
+struct WeightedKeySelector
+{
+	int operator()(const WeightedElement& element) const
+	{
+		return element.value;
+	}
+};
+
+struct WeightAugment
+{
+	using ValueType = double;
+
+	static double Identity()
+	{
+		return 0;
+	}
+
+	static double Value(const WeightedElement& element)
+	{
+		return element.weight;
+	}
+
+	static double Combine(double const lhs, double const rhs)
+	{
+		return lhs + rhs;
+	}
+
+	static double& Aggregate(WeightedElement& element)
+	{
+		return element.weightSum;
+	}
+};
+
+using WeightedSet = AvlSet<WeightedElement, WeightedKeySelector, std::compare_three_way, WeightAugment>;
+
+struct SmallWeightedElement : AvlSetLink
+{
+	int value;
+	uint8_t weight;
+	uint8_t weightSum;
+
+	SmallWeightedElement(int const value, uint8_t const weight)
+		: value(value)
+		, weight(weight)
+	{
+	}
+};
+
+struct SmallWeightedKeySelector
+{
+	int operator()(const SmallWeightedElement& element) const
+	{
+		return element.value;
+	}
+};
+
+// Weights of a type for which the standard distributions are not defined.
+struct SmallWeightAugment
+{
+	using ValueType = uint8_t;
+
+	static uint8_t Identity()
+	{
+		return 0;
+	}
+
+	static uint8_t Value(const SmallWeightedElement& element)
+	{
+		return element.weight;
+	}
+
+	static uint8_t Combine(uint8_t const lhs, uint8_t const rhs)
+	{
+		return static_cast<uint8_t>(lhs + rhs);
+	}
+
+	static uint8_t& Aggregate(SmallWeightedElement& element)
+	{
+		return element.weightSum;
+	}
+};
+
+using SmallWeightedSet = AvlSet<SmallWeightedElement, SmallWeightedKeySelector, std::compare_three_way, SmallWeightAugment>;
+
+struct StringElement : AvlSetKeyPrefixLink
+{
+	std::string value;
+
+	StringElement(std::string value)
+		: value(std::move(value))
+	{
+	}
+};
+
+struct StringKeySelector
+{
+	const std::string& operator()(const StringElement& element) const
+	{
+		return element.value;
+	}
+};
+
+using StringSet = AvlSet<StringElement, StringKeySelector, std::compare_three_way, NoAugment, StringKeyPrefix>;
+
+// Random strings sharing long prefixes, so that many comparisons fall back to the full keys.
+std::vector<std::string> MakeStrings(size_t const count)
+{
+	static constexpr std::string_view Prefixes[] = { "", "a", "abcdefg", "abcdefgh", "abcdefghij", "\xff\xfe" };
+
+	auto rng = Catch::rng();
+	std::uniform_int_distribution<size_t> prefixDistribution(0, std::size(Prefixes) - 1);
+	std::uniform_int_distribution<size_t> lengthDistribution(0, 4);
+	std::uniform_int_distribution<int> charDistribution(0, 255);
+
+	std::vector<std::string> strings;
+	for (size_t i = 0; i < count; ++i)
+	{
+		std::string string(Prefixes[prefixDistribution(rng)]);
+		for (size_t length = lengthDistribution(rng); length > 0; --length)
+			string.push_back(static_cast<char>(charDistribution(rng)));
+		strings.push_back(std::move(string));
+	}
+	return strings;
+}
+
 struct TwoSets
 {
 	std::list<Element> list;
@@ -174,6 +376,51 @@ TEST_CASE("AvlSet::Remove", "[AvlSet][Container]")
 	}
 }
 
+TEST_CASE("AvlSet::Relocate", "[AvlSet][Container]")
+{
+	Elements e;
+	Elements moved;
+
+	int const size = GENERATE(1, 2, 3, 10, 1000);
+
+	std::vector<int> values;
+	for (int i = 0; i < size; ++i)
+		values.push_back(i * 2);
+	std::ranges::shuffle(values, Catch::rng());
+
+	Set set;
+	for (int const value : values)
+		set.Insert(e(value));
+
+	// Relocate every other element in insertion order.
+	bool relocate = false;
+	for (Element& element : e.list)
+	{
+		relocate = !relocate;
+		if (relocate)
+		{
+			Element* const newElement = moved(0);
+			*newElement = element;
+			set.Relocate(&element, newElement);
+			element.value = -1;
+		}
+	}
+
+	REQUIRE(set.Size() == static_cast<size_t>(size));
+	REQUIRE(std::ranges::equal(std::views::iota(0, size) | std::views::transform([](int i) { return i * 2; }), Values(set)));
+
+	for (int i = 0; i < size; ++i)
+	{
+		Element* const element = set.Find(i * 2);
+		REQUIRE(element != nullptr);
+		REQUIRE(element->value == i * 2);
+		REQUIRE(set.Insert(e(i * 2 + 1)).Inserted);
+		set.Remove(element);
+	}
+
+	REQUIRE(std::ranges::equal(std::views::iota(0, size) | std::views::transform([](int i) { return i * 2 + 1; }), Values(set)));
+}
+
 TEST_CASE("AvlSet::Clear", "[AvlSet][Container]")
 {
 	UniqueElements e;
@@ -193,6 +440,890 @@ TEST_CASE("AvlSet::Clear", "[AvlSet][Container]")
 	REQUIRE(set.IsEmpty());
 }
 
+TEST_CASE("AvlSet::InsertHint", "[AvlSet][Container]")
+{
+	Elements e;
+
+	size_t comparisons = 0;
+	auto const comparator = [&](int const lhs, int const rhs)
+	{
+		++comparisons;
+		return lhs <=> rhs;
+	};
+
+	AvlSet<Element, KeySelector, decltype(comparator)> set(comparator);
+	std::set<int> std;
+
+	int const size = 1000;
+
+	SECTION("Ascending")
+	{
+		for (int i = 0; i < size; ++i)
+		{
+			REQUIRE(set.InsertHint(set.end(), e(i)).Inserted);
+			std.insert(i);
+		}
+		REQUIRE(comparisons <= static_cast<size_t>(size));
+	}
+
+	SECTION("Descending")
+	{
+		for (int i = size; i-- > 0;)
+		{
+			REQUIRE(set.InsertHint(set.begin(), e(i)).Inserted);
+			std.insert(i);
+		}
+		REQUIRE(comparisons <= static_cast<size_t>(size));
+	}
+
+	SECTION("AppendMax")
+	{
+		for (int i = 0; i < size; ++i)
+		{
+			REQUIRE(set.AppendMax(e(i)).Inserted);
+			std.insert(i);
+		}
+		REQUIRE(comparisons <= static_cast<size_t>(size));
+
+		Element* const element = e(size / 2);
+		REQUIRE(set.AppendMax(element).Element == set.Find(size / 2));
+		REQUIRE(set.AppendMax(e(size - 1)).Element == set.Find(size - 1));
+	}
+
+	SECTION("Random hints")
+	{
+		auto rng = Catch::rng();
+		std::uniform_int_distribution<int> distribution(0, size);
+
+		for (int i = 0; i < size; ++i)
+		{
+			int const value = distribution(rng);
+			auto const hint = set.LowerBound(distribution(rng));
+
+			auto const r = set.InsertHint(hint, e(value));
+			REQUIRE(r.Inserted == std.insert(value).second);
+			REQUIRE(r.Element->value == value);
+		}
+	}
+
+	REQUIRE(set.Size() == std.size());
+	REQUIRE(std::ranges::equal(std, Values(set)));
+}
+
+TEST_CASE("AvlSet::FindOrPrepare", "[AvlSet][Container]")
+{
+	Elements e;
+
+	size_t constructed = 0;
+
+	Set set;
+	std::set<int> std;
+
+	auto rng = Catch::rng();
+	std::uniform_int_distribution<int> distribution(0, 500);
+
+	for (int i = 0; i < 1000; ++i)
+	{
+		int const value = distribution(rng);
+
+		auto const r = set.FindOrPrepare(value);
+		REQUIRE((r.Element == nullptr) == std.insert(value).second);
+
+		if (r.Element == nullptr)
+		{
+			++constructed;
+			set.InsertAt(r.Position, e(value));
+		}
+		else
+		{
+			REQUIRE(r.Element->value == value);
+		}
+	}
+
+	REQUIRE(constructed == std.size());
+	REQUIRE(set.Size() == std.size());
+	REQUIRE(std::ranges::equal(std, Values(set)));
+}
+
+TEST_CASE("AvlSet::Build", "[AvlSet][Container]")
+{
+	Elements e;
+
+	int const size = GENERATE(0, 1, 2, 3, 4, 7, 8, 100, 1000);
+	size_t const usize = static_cast<size_t>(size);
+
+	Set set;
+
+	SECTION("From a list")
+	{
+		List<Element> list;
+		for (int i = 0; i < size; ++i)
+			list.Append(e(i * 10));
+
+		set.Build(list);
+		REQUIRE(list.IsEmpty());
+	}
+
+	SECTION("From a range")
+	{
+		std::vector<Element*> elements;
+		for (int i = 0; i < size; ++i)
+			elements.push_back(e(i * 10));
+
+		set.Build(elements);
+	}
+
+	REQUIRE(set.Size() == usize);
+	REQUIRE(std::ranges::equal(std::views::iota(0, size) | std::views::transform([](int i) { return i * 10; }), Values(set)));
+
+	REQUIRE(set.Insert(e(5)).Inserted);
+	REQUIRE(set.Insert(e(size * 10)).Inserted);
+	REQUIRE(set.Size() == usize + 2);
+
+	List<Element> list = set.Flatten();
+	REQUIRE(set.IsEmpty());
+	REQUIRE(list.Size() == usize + 2);
+	REQUIRE(std::ranges::is_sorted(Values(list)));
+}
+
+TEST_CASE("AvlSet::InsertSorted", "[AvlSet][Container]")
+{
+	Elements e;
+
+	auto rng = Catch::rng();
+	std::uniform_int_distribution<int> distribution(0, 5000);
+
+	Set set;
+	std::set<int> std;
+
+	int const size = GENERATE(0, 10, 1000);
+	set.Build(std::views::iota(0, size) | std::views::transform([&](int const i)
+	{
+		std.insert(i * 3);
+		return e(i * 3);
+	}));
+
+	int const count = GENERATE(0, 1, 100, 2000);
+
+	std::vector<int> batch;
+	for (int i = 0; i < count; ++i)
+		batch.push_back(distribution(rng));
+	std::ranges::sort(batch);
+
+	List<Element> list;
+	for (int const value : batch)
+		list.Append(e(value));
+
+	std::vector<int> rejected;
+	for (int const value : batch)
+	{
+		if (!std.insert(value).second)
+			rejected.push_back(value);
+	}
+
+	set.InsertSorted(list);
+
+	REQUIRE(set.Size() == std.size());
+	REQUIRE(std::ranges::equal(std, Values(set)));
+	REQUIRE(std::ranges::equal(rejected, Values(list)));
+}
+
+TEST_CASE("AvlSet::ForEach", "[AvlSet][Container]")
+{
+	UniqueElements e;
+
+	int const size = GENERATE(0, 1, 2, 100, 10000, 100000);
+
+	Set set;
+	set.Build(std::views::iota(0, size) | std::views::transform([&](int const value) { return e(value); }));
+
+	SECTION("Sequential")
+	{
+		std::vector<int> visited;
+		set.ForEach([&](Element& element) { visited.push_back(element.value); });
+		REQUIRE(std::ranges::equal(visited, std::views::iota(0, size)));
+
+		visited.clear();
+		std::as_const(set).ForEach([&](const Element& element) { visited.push_back(element.value); });
+		REQUIRE(std::ranges::equal(visited, std::views::iota(0, size)));
+	}
+
+	SECTION("Parallel")
+	{
+		std::vector<std::atomic<int>> counts(static_cast<size_t>(size));
+		auto const visit = [&](const Element& element)
+		{
+			counts[static_cast<size_t>(element.value)].fetch_add(1, std::memory_order_relaxed);
+		};
+
+		SECTION("Inline executor")
+		{
+			set.ParallelForEach(InlineExecutor(), visit);
+		}
+
+		SECTION("Thread executor")
+		{
+			std::as_const(set).ParallelForEach(ThreadExecutor(), visit);
+		}
+
+		REQUIRE(std::ranges::all_of(counts, [](const std::atomic<int>& count) { return count == 1; }));
+	}
+}
+
+TEST_CASE("AvlSet::CompactLayout", "[AvlSet][Container]")
+{
+	Elements e;
+
+	int const size = GENERATE(0, 1, 2, 3, 10, 1000);
+	size_t const usize = static_cast<size_t>(size);
+	AvlSetLayout const layout = GENERATE(AvlSetLayout::InOrder, AvlSetLayout::BreadthFirst);
+
+	std::vector<int> values;
+	for (int i = 0; i < size; ++i)
+		values.push_back(i);
+	std::ranges::shuffle(values, Catch::rng());
+
+	Set set;
+	for (int const value : values)
+		set.Insert(e(value));
+
+	std::allocator<Element> allocator;
+	Element* const buffer = allocator.allocate(usize);
+
+	set.CompactLayout(buffer, [](Element& element, Element* const destination)
+	{
+		std::construct_at(destination, std::move(element));
+	}, layout);
+
+	for (Element& element : e.list)
+		element.value = -1;
+
+	REQUIRE(set.Size() == usize);
+	REQUIRE(std::ranges::equal(std::views::iota(0, size), Values(set)));
+	REQUIRE(std::ranges::all_of(set, [&](const Element& element) { return &element >= buffer && &element < buffer + size; }));
+
+	if (layout == AvlSetLayout::InOrder)
+	{
+		REQUIRE(std::ranges::equal(std::views::iota(0, size), Values(std::span(buffer, usize))));
+	}
+	else if (size > 0)
+	{
+		REQUIRE(set.Root() == buffer);
+	}
+
+	for (int i = 0; i < size; ++i)
+		REQUIRE(set.Find(i) == std::ranges::find(buffer, buffer + size, i, &Element::value));
+
+	set.Clear();
+	std::destroy_n(buffer, usize);
+	allocator.deallocate(buffer, usize);
+}
+
+TEST_CASE("AvlSet::Flatten", "[AvlSet][Container]")
+{
+	Elements e;
+
+	auto rng = Catch::rng();
+	std::uniform_int_distribution distribution = {};
+
+	Set set;
+	std::set<int> stdSet;
+
+	for (size_t i = 0; i < 1000; ++i)
+	{
+		int const value = distribution(rng);
+		stdSet.insert(value);
+		set.Insert(e(value));
+	}
+
+	List<Element> list = set.Flatten();
+	REQUIRE(set.IsEmpty());
+	REQUIRE(std::ranges::equal(stdSet, Values(list)));
+	REQUIRE(std::ranges::equal(stdSet | std::views::reverse, Values(list) | std::views::reverse));
+
+	set.Build(list);
+	REQUIRE(std::ranges::equal(stdSet, Values(set)));
+}
+
+TEST_CASE("AvlSet::RemoveRange", "[AvlSet][Container]")
+{
+	Elements e;
+
+	auto rng = Catch::rng();
+	std::uniform_int_distribution<int> distribution(0, 2000);
+
+	Set set;
+	std::set<int> std;
+
+	for (int i = 0; i < 1000; ++i)
+	{
+		int const value = distribution(rng);
+		if (std.insert(value).second)
+			set.Insert(e(value));
+	}
+
+	for (int i = 0; i < 20; ++i)
+	{
+		int lo = distribution(rng);
+		int hi = lo + distribution(rng) / 10;
+
+		std::vector<int> const expected(std.lower_bound(lo), std.lower_bound(hi));
+		std.erase(std.lower_bound(lo), std.lower_bound(hi));
+
+		List<Element> const list = set.RemoveRange(lo, hi);
+		REQUIRE(list.Size() == expected.size());
+		REQUIRE(std::ranges::equal(expected, Values(list)));
+		REQUIRE(std::ranges::equal(expected | std::views::reverse, Values(list) | std::views::reverse));
+
+		REQUIRE(set.Size() == std.size());
+		REQUIRE(std::ranges::equal(std, Values(set)));
+	}
+
+	SECTION("Everything")
+	{
+		List<Element> const list = set.RemoveRange(-1, 2001);
+		REQUIRE(list.Size() == std.size());
+		REQUIRE(set.IsEmpty());
+	}
+
+	SECTION("Modify afterwards")
+	{
+		for (int i = 0; i < 100; ++i)
+		{
+			int const value = distribution(rng);
+			if (std.insert(value).second)
+				set.Insert(e(value));
+		}
+		REQUIRE(std::ranges::equal(std, Values(set)));
+	}
+}
+
+TEST_CASE("AvlSet::Split", "[AvlSet][Container]")
+{
+	Elements e;
+
+	auto rng = Catch::rng();
+
+	int const size = GENERATE(0, 1, 2, 3, 10, 100, 1000);
+	int const key = GENERATE(-1, 0, 1, 2, 3, 50, 499, 500, 1000, 1999, 2000, 2001);
+
+	// Insert every other value in random order.
+	std::vector<int> values;
+	for (int i = 0; i < size; ++i)
+		values.push_back(i * 2);
+	std::ranges::shuffle(values, rng);
+
+	Set set;
+	for (int const value : values)
+		set.Insert(e(value));
+
+	Set greater = set.Split(key);
+
+	std::vector<int> lValues;
+	std::vector<int> rValues;
+	for (int i = 0; i < size; ++i)
+		(i * 2 < key ? lValues : rValues).push_back(i * 2);
+
+	REQUIRE(std::ranges::equal(lValues, Values(set)));
+	REQUIRE(std::ranges::equal(rValues, Values(greater)));
+	REQUIRE(set.Size() == lValues.size());
+	REQUIRE(greater.Size() == rValues.size());
+
+	SECTION("Join the greater set")
+	{
+		set.Join(greater);
+		REQUIRE(greater.IsEmpty());
+	}
+
+	SECTION("Join the lesser set")
+	{
+		greater.Join(set);
+		REQUIRE(set.IsEmpty());
+		swap(set, greater);
+	}
+
+	REQUIRE(set.Size() == static_cast<size_t>(size));
+	REQUIRE(std::ranges::equal(std::views::iota(0, size) | std::views::transform([](int i) { return i * 2; }), Values(set)));
+
+	REQUIRE(set.Insert(e(-1)).Inserted);
+	REQUIRE(set.Insert(e(size * 2 + 1)).Inserted);
+}
+
+TEST_CASE("AvlSet::Split modified before counting", "[AvlSet][Container]")
+{
+	Elements e;
+
+	Set set;
+	for (int i = 0; i < 100; ++i)
+		set.Insert(e(i * 2));
+
+	// The sizes are unknown after splitting until they are first counted.
+	Set greater = set.Split(100);
+
+	SECTION("Insert and remove")
+	{
+		REQUIRE(set.Insert(e(1)).Inserted);
+		set.Remove(set.Find(0));
+		set.Remove(set.Find(2));
+		REQUIRE(greater.Insert(e(101)).Inserted);
+
+		REQUIRE(set.Size() == 49);
+		REQUIRE(greater.Size() == 51);
+	}
+
+	SECTION("Join")
+	{
+		set.Join(greater);
+		REQUIRE(set.Size() == 100);
+		REQUIRE(greater.Size() == 0);
+		REQUIRE(greater.IsEmpty());
+	}
+
+	SECTION("Remove range")
+	{
+		REQUIRE(Values(set.RemoveRange(10, 20)).size() == 5);
+		REQUIRE(set.Size() == 45);
+	}
+}
+
+TEST_CASE("AvlSet::Join", "[AvlSet][Container]")
+{
+	Elements e;
+
+	int const lSize = GENERATE(0, 1, 2, 5, 31, 32, 500);
+	int const rSize = GENERATE(0, 1, 2, 5, 31, 32, 500);
+
+	Set lSet;
+	Set rSet;
+
+	// Insert in ascending order to produce trees of different shapes.
+	for (int i = 0; i < lSize; ++i)
+		lSet.Insert(e(i));
+	for (int i = rSize; i-- > 0;)
+		rSet.Insert(e(lSize + i));
+
+	lSet.Join(rSet);
+
+	REQUIRE(rSet.IsEmpty());
+	REQUIRE(lSet.Size() == static_cast<size_t>(lSize + rSize));
+	REQUIRE(std::ranges::equal(std::views::iota(0, lSize + rSize), Values(lSet)));
+}
+
+TEST_CASE("AvlSet set algebra", "[AvlSet][Container]")
+{
+	Elements e;
+
+	auto rng = Catch::rng();
+
+	int const lSize = GENERATE(0, 1, 10, 1000, 20000);
+	int const rSize = GENERATE(0, 1, 10, 1000, 20000);
+	int const executor = GENERATE(0, 1, 2);
+
+	// Draw the keys from ranges of different density so that the sets overlap partially.
+	auto const makeSet = [&](Set& set, std::set<int>& std, int const size, int const range)
+	{
+		std::uniform_int_distribution<int> distribution(0, range);
+		while (std.size() < static_cast<size_t>(size))
+			std.insert(distribution(rng));
+
+		set.Build(std | std::views::transform([&](int const value) { return e(value); }));
+	};
+
+	Set lSet;
+	Set rSet;
+	std::set<int> lStd;
+	std::set<int> rStd;
+	makeSet(lSet, lStd, lSize, lSize * 2);
+	makeSet(rSet, rStd, rSize, rSize * 3);
+
+	auto const execute = [&](auto&& function)
+	{
+		switch (executor)
+		{
+		case 0: return function();
+		case 1: return function(InlineExecutor());
+		default: return function(ThreadExecutor());
+		}
+	};
+
+	SECTION("Union")
+	{
+		std::set<int> merged = lStd;
+		std::set<int> duplicates;
+		for (int const value : rStd)
+		{
+			if (!merged.insert(value).second)
+				duplicates.insert(value);
+		}
+
+		execute([&](auto&&... args) { lSet.Union(rSet, args...); });
+
+		REQUIRE(lSet.Size() == merged.size());
+		REQUIRE(rSet.Size() == duplicates.size());
+		REQUIRE(std::ranges::equal(merged, Values(lSet)));
+		REQUIRE(std::ranges::equal(duplicates, Values(rSet)));
+	}
+
+	SECTION("Intersect")
+	{
+		std::vector<int> kept;
+		std::vector<int> removed;
+		for (int const value : lStd)
+			(rStd.contains(value) ? kept : removed).push_back(value);
+
+		Set const x = execute([&](auto&&... args) { return lSet.Intersect(rSet, args...); });
+
+		REQUIRE(lSet.Size() == kept.size());
+		REQUIRE(x.Size() == removed.size());
+		REQUIRE(std::ranges::equal(kept, Values(lSet)));
+		REQUIRE(std::ranges::equal(removed, Values(x)));
+		REQUIRE(std::ranges::equal(rStd, Values(rSet)));
+	}
+
+	SECTION("Difference")
+	{
+		std::vector<int> kept;
+		std::vector<int> removed;
+		for (int const value : lStd)
+			(rStd.contains(value) ? removed : kept).push_back(value);
+
+		Set const x = execute([&](auto&&... args) { return lSet.Difference(rSet, args...); });
+
+		REQUIRE(lSet.Size() == kept.size());
+		REQUIRE(x.Size() == removed.size());
+		REQUIRE(std::ranges::equal(kept, Values(lSet)));
+		REQUIRE(std::ranges::equal(removed, Values(x)));
+		REQUIRE(std::ranges::equal(rStd, Values(rSet)));
+	}
+}
+
+TEST_CASE("AvlSet::FindBatch", "[AvlSet][Container]")
+{
+	Elements e;
+
+	int const size = GENERATE(0, 1, 10, 1000);
+	size_t const count = GENERATE(0, 1, 15, 16, 17, 1000);
+
+	Set set;
+	for (int i = 0; i < size; ++i)
+		set.Insert(e(i * 2));
+
+	auto rng = Catch::rng();
+	std::uniform_int_distribution<int> distribution(-1, size * 2);
+
+	std::vector<int> keys;
+	for (size_t i = 0; i < count; ++i)
+		keys.push_back(distribution(rng));
+
+	std::vector<Element*> elements(count);
+	set.FindBatch(keys, elements);
+
+	std::vector<const Element*> constElements(count);
+	std::as_const(set).FindBatch(keys, constElements);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		REQUIRE(elements[i] == set.Find(keys[i]));
+		REQUIRE(constElements[i] == set.Find(keys[i]));
+	}
+}
+
+TEST_CASE("AvlSet::LowerBound", "[AvlSet][Container]")
+{
+	static_assert(std::ranges::bidirectional_range<decltype(std::declval<Set&>().Range(0, 0))>);
+	static_assert(std::ranges::bidirectional_range<decltype(std::declval<const Set&>().Range(0, 0))>);
+
+	Elements e;
+
+	int const size = GENERATE(0, 1, 2, 3, 10, 100);
+
+	// Insert every other value in random order.
+	std::vector<int> values;
+	for (int i = 0; i < size; ++i)
+		values.push_back(i * 2);
+	std::ranges::shuffle(values, Catch::rng());
+
+	Set set;
+	std::set<int> std;
+	for (int const value : values)
+	{
+		set.Insert(e(value));
+		std.insert(value);
+	}
+
+	auto const toStd = [&](auto const it)
+	{
+		return it == set.end() ? std.end() : std.find(it->value);
+	};
+
+	for (int key = -1; key <= size * 2; ++key)
+	{
+		REQUIRE(toStd(set.LowerBound(key)) == std.lower_bound(key));
+		REQUIRE(toStd(set.UpperBound(key)) == std.upper_bound(key));
+		REQUIRE(toStd(set.LowerBoundEquivalent(static_cast<long>(key))) == std.lower_bound(key));
+		REQUIRE(toStd(set.UpperBoundEquivalent(static_cast<long>(key))) == std.upper_bound(key));
+
+		auto const range = set.EqualRange(key);
+		REQUIRE(std::ranges::distance(range) == static_cast<ptrdiff_t>(std.count(key)));
+		REQUIRE(toStd(range.begin()) == std.lower_bound(key));
+		REQUIRE(std::ranges::equal(Values(range), Values(set.EqualRangeEquivalent(static_cast<long>(key)))));
+	}
+
+	int const lo = GENERATE(-1, 0, 1, 5, 50);
+	int const hi = std::max(lo, GENERATE(0, 1, 6, 51, 300));
+
+	auto const range = set.Range(lo, hi);
+	auto const stdRange = std::ranges::subrange(std.lower_bound(lo), std.lower_bound(hi));
+
+	REQUIRE(std::ranges::equal(stdRange, Values(range)));
+	REQUIRE(std::ranges::equal(stdRange | std::views::reverse, Values(range | std::views::reverse)));
+	REQUIRE(std::ranges::equal(Values(range), Values(set.RangeEquivalent(static_cast<long>(lo), static_cast<long>(hi)))));
+}
+
+TEST_CASE("AvlSet key prefix", "[AvlSet][Container]")
+{
+	size_t const size = GENERATE(0, 1, 10, 1000);
+
+	std::list<StringElement> storage;
+	std::set<std::string> std;
+
+	StringSet set;
+	for (std::string const& string : MakeStrings(size))
+	{
+		StringElement* const element = &storage.emplace_back(string);
+		auto const r = set.Insert(element);
+		REQUIRE(r.Inserted == std.insert(string).second);
+
+		if (!r.Inserted)
+		{
+			REQUIRE(r.Element->value == string);
+			storage.pop_back();
+		}
+	}
+
+	SECTION("Union")
+	{
+		std::list<StringElement> otherStorage;
+		StringSet other;
+		for (std::string const& string : MakeStrings(size))
+		{
+			if (set.Find(string) == nullptr && std.insert(string).second)
+				other.Insert(&otherStorage.emplace_back(string));
+		}
+
+		set.Union(other);
+		REQUIRE(other.IsEmpty());
+		storage.splice(storage.end(), otherStorage);
+	}
+
+	REQUIRE(set.Size() == std.size());
+	REQUIRE(std::ranges::equal(std, set | std::views::transform(StringKeySelector())));
+
+	std::vector<std::string> const keys = MakeStrings(100);
+	std::vector<StringElement*> elements(keys.size());
+	set.FindBatch(keys, elements);
+
+	for (size_t i = 0; i < keys.size(); ++i)
+	{
+		std::string const& key = keys[i];
+
+		StringElement* const element = set.Find(key);
+		REQUIRE((element != nullptr) == std.contains(key));
+		REQUIRE((element == nullptr || element->value == key));
+		REQUIRE(set.FindEquivalent(std::string_view(key)) == element);
+		REQUIRE(elements[i] == element);
+
+		auto const bound = std.lower_bound(key);
+		auto const it = set.LowerBound(key);
+		REQUIRE((it == set.end()) == (bound == std.end()));
+		REQUIRE((it == set.end() || it->value == *bound));
+	}
+
+	for (auto it = storage.begin(); it != storage.end(); it = storage.erase(it))
+		set.Remove(&*it);
+	REQUIRE(set.IsEmpty());
+}
+
+TEST_CASE("AvlSet augmentation", "[AvlSet][Container]")
+{
+	std::list<AugmentedElement> storage;
+	auto const e = [&](int const value)
+	{
+		return &storage.emplace_back(value);
+	};
+
+	auto rng = Catch::rng();
+	std::uniform_int_distribution<int> distribution(0, 2000);
+
+	auto const check = [&](const AugmentedSet& set)
+	{
+		auto const fold = [](auto&& range)
+		{
+			AugmentedElement::Hash hash = HashAugment::Identity();
+			for (const AugmentedElement& element : range)
+				hash = HashAugment::Combine(hash, HashAugment::Value(element));
+			return hash;
+		};
+
+		REQUIRE(set.Aggregate() == fold(set));
+
+		for (int i = 0; i < 50; ++i)
+		{
+			int const lo = distribution(rng);
+			int const hi = std::max(lo, distribution(rng));
+			REQUIRE(set.Aggregate(lo, hi) == fold(set.Range(lo, hi)));
+		}
+	};
+
+	AugmentedSet set;
+
+	SECTION("Insert and Remove")
+	{
+		std::vector<AugmentedElement*> elements;
+		for (int i = 0; i < 2000; ++i)
+		{
+			if (!elements.empty() && distribution(rng) % 3 == 0)
+			{
+				size_t const index = static_cast<size_t>(distribution(rng)) % elements.size();
+				set.Remove(elements[index]);
+				elements[index] = elements.back();
+				elements.pop_back();
+			}
+			else
+			{
+				auto const r = set.InsertHint(set.LowerBound(distribution(rng)), e(distribution(rng)));
+				if (r.Inserted) elements.push_back(r.Element);
+			}
+		}
+		check(set);
+	}
+
+	SECTION("Build, Split and Join")
+	{
+		set.Build(std::views::iota(0, 1000) | std::views::transform([&](int const i) { return e(i * 2); }));
+		check(set);
+
+		int const key = distribution(rng);
+		AugmentedSet greater = set.Split(key);
+		check(set);
+		check(greater);
+
+		set.Join(greater);
+		check(set);
+	}
+
+	SECTION("Set algebra")
+	{
+		AugmentedSet other;
+		std::set<int> values;
+		for (int i = 0; i < 1000; ++i)
+		{
+			set.Insert(e(distribution(rng)));
+			values.insert(distribution(rng));
+		}
+		other.Build(values | std::views::transform([&](int const value) { return e(value); }));
+
+		AugmentedSet removed = set.Difference(other);
+		check(set);
+		check(removed);
+
+		set.Union(removed);
+		check(set);
+		check(removed);
+
+		AugmentedSet const x = set.Intersect(other, ThreadExecutor());
+		check(set);
+		check(x);
+	}
+}
+
+TEST_CASE("AvlSet::SampleWeighted", "[AvlSet][Container]")
+{
+	std::list<WeightedElement> storage;
+
+	auto rng = Catch::rng();
+
+	WeightedSet set;
+	REQUIRE(set.SampleWeighted(rng) == nullptr);
+
+	// Weights proportional to the values, with zero weights for odd values.
+	double total = 0;
+	for (int i = 0; i < 100; ++i)
+	{
+		double const weight = i % 2 == 0 ? i : 0;
+		set.Insert(&storage.emplace_back(i, weight));
+		total += weight;
+	}
+
+	std::vector<size_t> counts(100);
+	size_t const samples = 200000;
+	for (size_t i = 0; i < samples; ++i)
+	{
+		const WeightedElement* const element = std::as_const(set).SampleWeighted(rng);
+		REQUIRE(element != nullptr);
+		++counts[static_cast<size_t>(element->value)];
+	}
+
+	for (int i = 0; i < 100; ++i)
+	{
+		double const expected = (i % 2 == 0 ? i : 0) / total;
+		REQUIRE(static_cast<double>(counts[static_cast<size_t>(i)]) / samples == Approx(expected).margin(0.005));
+	}
+}
+
+TEST_CASE("AvlSet::SampleWeighted small integer weights", "[AvlSet][Container]")
+{
+	std::list<SmallWeightedElement> storage;
+
+	auto rng = Catch::rng();
+
+	SmallWeightedSet set;
+	REQUIRE(set.SampleWeighted(rng) == nullptr);
+
+	// Weights 0, 1, 2 and 3 repeating, with a total of 30 which fits in the weight type.
+	size_t total = 0;
+	for (int i = 0; i < 20; ++i)
+	{
+		uint8_t const weight = static_cast<uint8_t>(i % 4);
+		set.Insert(&storage.emplace_back(i, weight));
+		total += weight;
+	}
+	REQUIRE(set.Aggregate() == total);
+
+	std::vector<size_t> counts(20);
+	size_t const samples = 60000;
+	for (size_t i = 0; i < samples; ++i)
+		++counts[static_cast<size_t>(set.SampleWeighted(rng)->value)];
+
+	for (int i = 0; i < 20; ++i)
+	{
+		double const expected = static_cast<double>(i % 4) / static_cast<double>(total);
+		REQUIRE(static_cast<double>(counts[static_cast<size_t>(i)]) / samples == Approx(expected).margin(0.01));
+	}
+}
+
+TEST_CASE("AvlSet::SampleWeighted small integer total at capacity", "[AvlSet][Container]")
+{
+	std::list<SmallWeightedElement> storage;
+
+	auto rng = Catch::rng();
+
+	// The total weight of 255 is the largest the weight type can represent,
+	// and the subtree sums are computed in it without being truncated.
+	SmallWeightedSet set;
+	for (int i = 0; i < 17; ++i)
+		set.Insert(&storage.emplace_back(i, uint8_t(15)));
+	REQUIRE(set.Aggregate() == 255);
+
+	std::vector<size_t> counts(17);
+	size_t const samples = 68000;
+	for (size_t i = 0; i < samples; ++i)
+		++counts[static_cast<size_t>(set.SampleWeighted(rng)->value)];
+
+	for (size_t const count : counts)
+		REQUIRE(static_cast<double>(count) / samples == Approx(1.0 / 17).margin(0.01));
+}
+
 TEST_CASE("AvlSet iteration.", "[AvlSet][Container]")
 {
 	Elements e;
@@ -201,6 +1332,7 @@ TEST_CASE("AvlSet iteration.", "[AvlSet][Container]")
 
 	for (int i : std::views::iota(1, 100) | std::views::reverse) set.Insert(e(i));
 	REQUIRE(std::ranges::equal(std::views::iota(1, 100), Values(set)));
+	REQUIRE(std::ranges::equal(std::views::iota(1, 100) | std::views::reverse, Values(set) | std::views::reverse));
 }
 
 TEST_CASE("AvlSet mass test.", "[AvlSet][Container]")
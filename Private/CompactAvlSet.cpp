@@ -0,0 +1,266 @@
+#include "Eco/CompactAvlSet.hpp"
+
+#include <algorithm>
+
+#include <cmath>
+
+using namespace Eco;
+using namespace Private::CompactAvlSet_;
+
+static_assert(sizeof(Hook) == sizeof(CompactAvlSetLink));
+static_assert(CheckCompleteTaggedPointer<Ptr<Hook>>());
+
+
+// Rotate from left to right. The slot is the pointer to the root.
+static void Rotate(Ptr<Hook>* const slot, Hook* const root, bool const l, bool const single, bool const rootBalance)
+{
+	bool const r = !l;
+
+	Hook* const pivot = root->children[l].Ptr();
+	Hook* const child = pivot->children[r].Ptr();
+
+	bool const balance = !pivot->children[l].Tag() & single;
+
+	root->children[l].Set(child, balance);
+	root->children[r].SetTag(rootBalance);
+
+	pivot->children[l].SetTag(0);
+	pivot->children[r].Set(root, balance);
+
+	slot->SetPtr(pivot);
+}
+
+// Retrace the heights along the path from the changed subtree at slots[depth] towards the root.
+static void Retrace(Ptr<Hook>* const* const slots, size_t const depth, bool const insert)
+{
+	for (size_t k = depth; k-- > 0;)
+	{
+		Ptr<Hook>* const slot = slots[k];
+		Hook* const parent = slot->Ptr();
+
+		// The next slot on the path is one of the parent's children.
+		bool const l = (slots[k + 1] != parent->children) ^ !insert;
+		bool const r = !l;
+
+		// If the node is now +2 on the l side.
+		if (parent->children[l].Tag())
+		{
+			Hook* const child = parent->children[l].Ptr();
+
+			bool const doubleRotation = child->children[r].Tag();
+			bool const removalBalance = child->children[l].Tag();
+
+			bool balance = 0;
+			if (doubleRotation)
+			{
+				Hook* const pivot = child->children[r].Ptr();
+				balance = pivot->children[l].Tag();
+
+				// Rotate hook from r to l to allow the
+				// subsequent parent rotation to balance the parent.
+				Rotate(&parent->children[l], child, r, false, pivot->children[r].Tag());
+			}
+
+			// Rotate parent from l to r to balance.
+			Rotate(slot, parent, l, !doubleRotation, balance);
+
+			// On insertion a single or double rotation always balances the tree.
+			// On removal a single rotation balances the tree if the pivot is balanced.
+			if (insert || doubleRotation == removalBalance) return;
+		}
+		else
+		{
+			// The node is either 0 or +1 on the l side.
+			// Update the node's balancing factors.
+			bool const balance = parent->children[r].Tag();
+
+			// The l side becomes 1, or cancels out with the r side.
+			parent->children[l].TagProxy() |= !balance;
+
+			// The r side either is already 0, or it becomes 0.
+			parent->children[r].SetTag(0);
+
+			// If the r side is 1, the height of this subtree does not change.
+			if (balance == insert) return;
+		}
+	}
+}
+
+// Returns the height of the subtree, or -1 if it is not balanced.
+static int Invariant(const Hook* const hook, size_t& size)
+{
+	if (hook == nullptr)
+		return 0;
+
+	int const lHeight = Invariant(hook->children[0].Ptr(), size);
+	int const rHeight = Invariant(hook->children[1].Ptr(), size);
+
+	if (lHeight < 0 || rHeight < 0)
+		return -1;
+
+	if (std::abs(lHeight - rHeight) > 1)
+		return -1;
+	if (hook->children[0].Tag() != (lHeight > rHeight))
+		return -1;
+	if (hook->children[1].Tag() != (rHeight > lHeight))
+		return -1;
+
+	++size;
+	return std::max(lHeight, rHeight) + 1;
+}
+
+static bool Invariant(const Core* const self)
+{
+	if (self->m_root->Tag() != 0)
+		return false;
+
+	size_t size = 0;
+	if (Invariant(self->m_root->Ptr(), size) < 0)
+		return false;
+
+	return size == self->m_size.Value;
+}
+
+
+void Core::Insert(Hook* const hook, Path& path)
+{
+	LinkInsert(*hook, *this);
+
+	Eco_Assert(path.slots[path.depth]->IsZero());
+
+	hook->children[0] = nullptr;
+	hook->children[1] = nullptr;
+	path.slots[path.depth]->SetPtr(hook);
+
+	Retrace(path.slots, path.depth, true);
+	++m_size.Value;
+
+	Eco_AssertSlow(Invariant(this));
+}
+
+void Core::Remove(Path& path)
+{
+	size_t const depth = path.depth;
+	Ptr<Hook>* const slot = path.slots[depth];
+	Hook* const hook = slot->Ptr();
+
+	LinkRemove(*hook, *this);
+
+	size_t balanceDepth = depth;
+
+	// If hook is not a leaf.
+	if (!hook->children[0].IsZero() || !hook->children[1].IsZero())
+	{
+		// Taller side of the tree on the left.
+		bool const succL = hook->children[1].Tag();
+		bool const succR = !succL;
+
+		// Extend the path to the in-order successor of the hook on the taller side of the tree.
+		Ptr<Hook>* succSlot = &hook->children[succL];
+		path.slots[++balanceDepth] = succSlot;
+
+		while (!succSlot->Ptr()->children[succR].IsZero())
+		{
+			succSlot = &succSlot->Ptr()->children[succR];
+			path.slots[++balanceDepth] = succSlot;
+		}
+
+		Hook* const successor = succSlot->Ptr();
+
+		// Attach the successor's child to the successor's parent.
+		succSlot->SetPtr(successor->children[succL].Ptr());
+
+		// Replace the hook with the successor.
+		successor->children[0] = hook->children[0];
+		successor->children[1] = hook->children[1];
+		slot->SetPtr(successor);
+
+		// The path continues through the successor in place of the hook.
+		path.slots[depth + 1] = &successor->children[succL];
+	}
+	else
+	{
+		slot->SetPtr(nullptr);
+	}
+
+	hook->children[0] = nullptr;
+	hook->children[1] = nullptr;
+
+	Retrace(path.slots, balanceDepth, false);
+	--m_size.Value;
+
+	Eco_AssertSlow(Invariant(this));
+}
+
+void Core::Clear()
+{
+	Hook* hook = m_root->Ptr();
+
+	while (hook != nullptr)
+	{
+		if (Hook* const child = hook->children[0].Ptr())
+		{
+			// Rotate the left child up, so that the leftmost hook eventually becomes the root.
+			hook->children[0] = child->children[1];
+			child->children[1].Set(hook, 0);
+			hook = child;
+		}
+		else
+		{
+			Hook* const next = hook->children[1].Ptr();
+
+			hook->children[0] = nullptr;
+			hook->children[1] = nullptr;
+			LinkRemove(*hook, *this);
+
+			hook = next;
+		}
+	}
+
+	m_root = nullptr;
+	m_size = 0;
+
+	Eco_AssertSlow(Invariant(this));
+}
+
+
+void IteratorCore::Descend(Hook* hook, bool const l)
+{
+	while (true)
+	{
+		Eco_Assert(m_depth < MaxHeight);
+		m_path[m_depth++] = hook;
+
+		if (hook->children[l].IsZero()) break;
+		hook = hook->children[l].Ptr();
+	}
+}
+
+void IteratorCore::Begin(bool const l)
+{
+	m_depth = 0;
+
+	if (!m_root->IsZero())
+		Descend(m_root->Ptr(), l);
+}
+
+void IteratorCore::Advance(bool const l)
+{
+	bool const r = !l;
+
+	// Advancing past the end wraps around.
+	if (m_depth == 0) return Begin(l);
+
+	Hook* hook = m_path[m_depth - 1];
+
+	// If node has a right child: stop at its leftmost descendant.
+	if (!hook->children[r].IsZero()) return Descend(hook->children[r].Ptr(), l);
+
+	// Iterate through ancestors until the branch where the hook is the l child.
+	while (--m_depth != 0)
+	{
+		Hook* const parent = m_path[m_depth - 1];
+		if (parent->children[l].Ptr() == hook) break;
+		hook = parent;
+	}
+}
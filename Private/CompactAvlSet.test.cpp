@@ -0,0 +1,146 @@
+#include "Eco/CompactAvlSet.hpp"
+
+#include "catch2/catch.hpp"
+
+#include <algorithm>
+#include <list>
+#include <set>
+#include <vector>
+
+using namespace Eco;
+
+namespace {
+
+struct CompactElement : CompactAvlSetLink
+{
+	int value;
+
+	CompactElement(int const value)
+		: value(value)
+	{
+	}
+};
+
+struct KeySelector
+{
+	int operator()(const CompactElement& element) const
+	{
+		return element.value;
+	}
+};
+
+using Set = CompactAvlSet<CompactElement, KeySelector>;
+
+std::vector<int> Values(const Set& set)
+{
+	std::vector<int> values;
+	for (const CompactElement& element : set)
+		values.push_back(element.value);
+	return values;
+}
+
+std::vector<int> ReverseValues(const Set& set)
+{
+	std::vector<int> values;
+	for (auto it = set.end(); it != set.begin();)
+		values.push_back((--it)->value);
+	return values;
+}
+
+} // namespace
+
+TEST_CASE("CompactAvlSet::Insert", "[CompactAvlSet][Container]")
+{
+	std::list<CompactElement> storage;
+
+	auto rng = Catch::rng();
+	std::uniform_int_distribution<int> distribution(0, GENERATE(10, 1000, 100000));
+
+	Set set;
+	std::set<int> std;
+
+	for (int i = 0; i < 2000; ++i)
+	{
+		int const value = distribution(rng);
+		CompactElement* const element = &storage.emplace_back(value);
+
+		auto const result = set.Insert(element);
+		REQUIRE(result.Inserted == std.insert(value).second);
+
+		if (!result.Inserted)
+		{
+			REQUIRE(result.Element->value == value);
+			storage.pop_back();
+		}
+	}
+
+	REQUIRE(set.Size() == std.size());
+	REQUIRE(std::ranges::equal(Values(set), std));
+	REQUIRE(std::ranges::equal(ReverseValues(set), std::vector<int>(std.rbegin(), std.rend())));
+
+	for (int const value : std)
+	{
+		CompactElement* const element = set.Find(value);
+		REQUIRE(element != nullptr);
+		REQUIRE(element->value == value);
+	}
+}
+
+TEST_CASE("CompactAvlSet::Remove", "[CompactAvlSet][Container]")
+{
+	std::list<CompactElement> storage;
+
+	auto rng = Catch::rng();
+	std::uniform_int_distribution<int> distribution(0, 999);
+
+	Set set;
+	std::set<int> std;
+
+	for (int i = 0; i < 4000; ++i)
+	{
+		int const value = distribution(rng);
+
+		if (CompactElement* const element = set.Find(value))
+		{
+			set.Remove(element);
+			std.erase(value);
+		}
+		else
+		{
+			set.Insert(&storage.emplace_back(value));
+			std.insert(value);
+		}
+
+		REQUIRE(set.Size() == std.size());
+	}
+
+	REQUIRE(std::ranges::equal(Values(set), std));
+
+	for (int const value : std::vector<int>(std.begin(), std.end()))
+	{
+		set.Remove(set.Find(value));
+		std.erase(value);
+	}
+
+	REQUIRE(set.IsEmpty());
+	REQUIRE(set.begin() == set.end());
+}
+
+TEST_CASE("CompactAvlSet::Clear", "[CompactAvlSet][Container]")
+{
+	std::list<CompactElement> storage;
+
+	Set set;
+	for (int i = 0; i < 100; ++i)
+		set.Insert(&storage.emplace_back(i));
+
+	set.Clear();
+	REQUIRE(set.IsEmpty());
+	REQUIRE(set.begin() == set.end());
+
+	// The elements can be inserted again after clearing.
+	for (CompactElement& element : storage)
+		set.Insert(&element);
+
+	REQUIRE(set.Size() == storage.size());
+}
@@ -0,0 +1,172 @@
+#include "Eco/ConcurrentAvlSet.hpp"
+
+#include "Elements.test.hpp"
+
+#include "catch2/catch.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace Eco;
+
+namespace {
+
+struct ValueSelector
+{
+	int operator()(const Element& element) const
+	{
+		return element.value;
+	}
+};
+
+using Set = ConcurrentAvlSet<Element, ValueSelector>;
+
+} // namespace
+
+TEST_CASE("ConcurrentAvlSet::Insert", "[ConcurrentAvlSet][Container]")
+{
+	Elements e;
+
+	Set set;
+	for (int i = 0; i < 100; ++i)
+	{
+		REQUIRE(set.Insert(e(i * 2)).Inserted);
+		REQUIRE(!set.Insert(e(i * 2)).Inserted);
+	}
+
+	REQUIRE(set.Size() == 100);
+
+	for (int i = 0; i < 199; ++i)
+	{
+		Element* const element = set.Find(i);
+		REQUIRE((element != nullptr) == (i % 2 == 0));
+		if (element != nullptr) REQUIRE(element->value == i);
+
+		Element* const bound = set.LowerBound(i);
+		REQUIRE(bound != nullptr);
+		REQUIRE(bound->value == (i + 1) / 2 * 2);
+	}
+
+	REQUIRE(set.LowerBound(199) == nullptr);
+}
+
+TEST_CASE("ConcurrentAvlSet concurrent readers", "[ConcurrentAvlSet][Container]")
+{
+	int const size = 1000;
+
+	// The elements outlive all readers, so removed elements remain valid.
+	std::vector<Element> elements;
+	elements.reserve(size);
+	for (int i = 0; i < size; ++i)
+		elements.emplace_back(i);
+
+	Set set;
+
+	// Even keys are always present, while odd keys come and go.
+	for (int i = 0; i < size; i += 2)
+		set.Insert(&elements[i]);
+
+	std::atomic<bool> stop = false;
+	std::atomic<size_t> failures = 0;
+
+	std::vector<std::jthread> readers;
+	for (int r = 0; r < 3; ++r)
+	{
+		readers.emplace_back([&, r]
+		{
+			auto rng = std::minstd_rand(r);
+			std::uniform_int_distribution<int> distribution(0, size - 1);
+
+			while (!stop.load(std::memory_order_relaxed))
+			{
+				int const value = distribution(rng);
+				Element* const element = set.Find(value);
+
+				if (element != nullptr ? element->value != value : value % 2 == 0)
+					failures.fetch_add(1, std::memory_order_relaxed);
+
+				Element* const bound = set.LowerBound(value);
+				if (bound == nullptr || bound->value < value || bound->value > value + 1)
+				{
+					if (value != size - 1 || bound != nullptr)
+						failures.fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+		});
+	}
+
+	auto rng = Catch::rng();
+	std::uniform_int_distribution<int> distribution(0, size / 2 - 1);
+
+	for (int i = 0; i < 20000; ++i)
+	{
+		Element* const element = &elements[distribution(rng) * 2 + 1];
+
+		if (set.Find(element->value) != nullptr)
+			set.Remove(element);
+		else
+			set.Insert(element);
+	}
+
+	stop = true;
+	readers.clear();
+
+	REQUIRE(failures == 0);
+
+	set.Clear();
+}
+
+TEST_CASE("ConcurrentAvlSet concurrent clear", "[ConcurrentAvlSet][Container]")
+{
+	int const size = 200;
+
+	std::vector<Element> elements;
+	elements.reserve(size);
+	for (int i = 0; i < size; ++i)
+		elements.emplace_back(i);
+
+	Set set;
+
+	std::atomic<bool> stop = false;
+	std::atomic<size_t> failures = 0;
+
+	std::vector<std::jthread> readers;
+	for (int r = 0; r < 3; ++r)
+	{
+		readers.emplace_back([&, r]
+		{
+			auto rng = std::minstd_rand(r);
+			std::uniform_int_distribution<int> distribution(0, size - 1);
+
+			while (!stop.load(std::memory_order_relaxed))
+			{
+				int const value = distribution(rng);
+
+				// Any key may be absent, but a found element must match the key.
+				Element* const element = set.Find(value);
+				if (element != nullptr && element->value != value)
+					failures.fetch_add(1, std::memory_order_relaxed);
+
+				Element* const bound = set.LowerBound(value);
+				if (bound != nullptr && bound->value < value)
+					failures.fetch_add(1, std::memory_order_relaxed);
+			}
+		});
+	}
+
+	// Removed hooks are reinitialized by the next insertion while readers may still visit them.
+	for (int round = 0; round < 200; ++round)
+	{
+		for (Element& element : elements)
+			set.Insert(&element);
+
+		REQUIRE(set.Size() == size);
+		set.Clear();
+	}
+
+	stop = true;
+	readers.clear();
+
+	REQUIRE(failures == 0);
+}
@@ -0,0 +1,76 @@
+#include "Eco/Executor.hpp"
+
+#include "Eco/Atomic.hpp"
+
+#include <algorithm>
+#include <latch>
+#include <thread>
+
+using namespace Eco;
+using namespace Private;
+
+namespace {
+
+struct RunState
+{
+	void(*function)(void* context, size_t index);
+	void* context;
+	size_t count;
+
+	atomic<size_t> next;
+	std::latch done;
+
+	RunState(void(* const function)(void*, size_t), void* const context, size_t const count, size_t const tasks)
+		: function(function)
+		, context(context)
+		, count(count)
+		, next(0)
+		, done(static_cast<ptrdiff_t>(tasks))
+	{
+	}
+
+	// Claim and run indices until there are none left.
+	void Drain()
+	{
+		for (size_t index; (index = next.fetch_add(1, std::memory_order::relaxed)) < count;)
+			function(context, index);
+	}
+};
+
+} // namespace
+
+size_t ExecutorRef::Concurrency() const
+{
+	return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+void ExecutorRef::Run(size_t const count, void(* const function)(void* context, size_t index), void* const context) const
+{
+	if (count <= 1)
+	{
+		if (count != 0) function(context, 0);
+		return;
+	}
+
+	// Tasks claim indices dynamically, so a task which starts late finds no
+	// work left instead of holding up the caller.
+	size_t const tasks = count - 1;
+	RunState state(function, context, count, tasks);
+
+	for (size_t i = 0; i < tasks; ++i)
+	{
+		m_submit(m_executor, ExecutorTask
+		{
+			[](void* const context)
+			{
+				RunState& state = *static_cast<RunState*>(context);
+				state.Drain();
+				state.done.count_down();
+			},
+			&state,
+		});
+	}
+
+	state.Drain();
+	state.done.wait();
+}
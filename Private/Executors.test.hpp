@@ -0,0 +1,30 @@
+#pragma once
+
+#include "Eco/Executor.hpp"
+
+#include <thread>
+#include <vector>
+
+namespace Eco {
+
+// Runs each task on a new thread.
+struct ThreadExecutor
+{
+	std::vector<std::jthread> threads;
+
+	void operator()(ExecutorTask const task)
+	{
+		threads.emplace_back(task);
+	}
+};
+
+// Runs each task immediately on the submitting thread.
+struct InlineExecutor
+{
+	void operator()(ExecutorTask const task) const
+	{
+		task();
+	}
+};
+
+} // namespace Eco
@@ -0,0 +1,84 @@
+#include "Eco/FrozenIndex.hpp"
+#include "Eco/AvlSet.hpp"
+#include "Eco/WbSet.hpp"
+
+#include "Elements.test.hpp"
+
+#include "catch2/catch.hpp"
+
+#include <set>
+
+using namespace Eco;
+
+namespace {
+
+struct ValueSelector
+{
+	int operator()(const Element& element) const
+	{
+		return element.value;
+	}
+};
+
+using Index = FrozenIndex<Element, ValueSelector>;
+
+template<typename TSet>
+void CheckIndex(TSet& set, const Index& index, const std::set<int>& std, int const max)
+{
+	REQUIRE(index.Size() == std.size());
+
+	for (int key = -1; key <= max + 1; ++key)
+	{
+		REQUIRE(index.Find(key) == set.Find(key));
+
+		auto const it = std.lower_bound(key);
+		Element* const bound = index.LowerBound(key);
+		REQUIRE((bound != nullptr) == (it != std.end()));
+		if (bound != nullptr) REQUIRE(bound->value == *it);
+	}
+}
+
+} // namespace
+
+TEST_CASE("FrozenIndex::Find", "[FrozenIndex][Container]")
+{
+	UniqueElements e;
+
+	int const max = GENERATE(0, 1, 2, 100, 5000);
+
+	auto rng = Catch::rng();
+	std::uniform_int_distribution<int> distribution(0, max);
+
+	std::set<int> std;
+	for (int i = 0; i < max / 2 + 1; ++i)
+		std.insert(distribution(rng));
+
+	SECTION("AvlSet")
+	{
+		AvlSet<Element, ValueSelector> set;
+		for (int const value : std)
+			set.Insert(e(value));
+
+		Index const index(set);
+		CheckIndex(set, index, std, max);
+	}
+
+	SECTION("WbSet")
+	{
+		WbSet<Element, ValueSelector> set;
+		for (int const value : std)
+			set.Insert(e(value));
+
+		Index const index(set);
+		CheckIndex(set, index, std, max);
+	}
+}
+
+TEST_CASE("FrozenIndex::Empty", "[FrozenIndex][Container]")
+{
+	Index const index;
+
+	REQUIRE(index.IsEmpty());
+	REQUIRE(index.Find(0) == nullptr);
+	REQUIRE(index.LowerBound(0) == nullptr);
+}
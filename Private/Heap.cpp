@@ -213,6 +213,19 @@ void Core::Remove(Hook* const hook, Comparator* const comparator)
 	Eco_AssertSlow(Invariant(this));
 }
 
+void Core::Relocate(Hook* const hook, Hook* const newHook)
+{
+	LinkRelocate(*hook, *newHook, *this);
+
+	Hook** const parent = newHook->parent;
+	parent[parent[0] != hook] = newHook;
+
+	for (Hook* const child : newHook->children)
+		if (child != nullptr) child->parent = newHook->children;
+
+	Eco_AssertSlow(Invariant(this));
+}
+
 Hook* Core::Pop(Comparator* const comparator)
 {
 	Eco_Assert(m_size > 0);
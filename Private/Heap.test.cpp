@@ -4,6 +4,7 @@
 
 #include "catch2/catch.hpp"
 
+#include <algorithm>
 #include <random>
 
 using namespace Eco;
@@ -107,6 +108,39 @@ TEST_CASE("Heap::Remove", "[Heap][Container]")
 	CHECK(heaps.IsEmpty());
 }
 
+TEST_CASE("Heap::Relocate", "[Heap][Container]")
+{
+	Heap<Element, KeySelector> heap;
+	Elements elements;
+	Elements moved;
+
+	int const size = GENERATE(1, 2, 7, 100);
+
+	std::vector<int> values;
+	for (int i = 0; i < size; ++i)
+		values.push_back(i);
+	std::ranges::shuffle(values, Catch::rng());
+
+	for (int const value : values)
+		heap.Push(elements(value));
+
+	for (Element& element : elements.list)
+	{
+		Element* const newElement = moved(0);
+		*newElement = element;
+		heap.Relocate(&element, newElement);
+		element.value = -1;
+	}
+
+	for (int i = size; i-- > 0;)
+	{
+		Element* const element = heap.Pop();
+		CHECK(element->value == i);
+		CHECK(std::ranges::any_of(moved.list, [&](const Element& x) { return &x == element; }));
+	}
+	CHECK(heap.IsEmpty());
+}
+
 TEST_CASE("Heap mass test.", "[Heap][Container]")
 {
 	std::vector<int> array;
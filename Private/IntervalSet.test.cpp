@@ -0,0 +1,146 @@
+#include "Eco/IntervalSet.hpp"
+
+#include "catch2/catch.hpp"
+
+#include <algorithm>
+#include <list>
+#include <random>
+#include <vector>
+
+using namespace Eco;
+
+namespace {
+
+struct Interval : IntervalSetLink<int>
+{
+	int lo;
+	int hi;
+
+	Interval(int const lo, int const hi)
+		: lo(lo)
+		, hi(hi)
+	{
+	}
+};
+
+struct LoSelector
+{
+	int operator()(const Interval& interval) const
+	{
+		return interval.lo;
+	}
+};
+
+struct HiSelector
+{
+	int operator()(const Interval& interval) const
+	{
+		return interval.hi;
+	}
+};
+
+using Set = IntervalSet<Interval, LoSelector, HiSelector>;
+
+struct TwoSets
+{
+	std::list<Interval> list;
+	Set eco;
+
+	void Insert(int const lo, int const hi)
+	{
+		eco.Insert(&list.emplace_back(lo, hi));
+	}
+
+	void Remove(std::list<Interval>::iterator const it)
+	{
+		eco.Remove(&*it);
+		list.erase(it);
+	}
+
+	std::vector<const Interval*> Expected(int const lo, int const hi, bool const closed) const
+	{
+		std::vector<const Interval*> expected;
+		for (const Interval& interval : eco)
+		{
+			if ((closed ? interval.lo <= hi : interval.lo < hi) && interval.hi > lo)
+				expected.push_back(&interval);
+		}
+		return expected;
+	}
+
+	void Check(int const lo, int const hi) const
+	{
+		std::vector<const Interval*> overlapping;
+		eco.FindOverlapping(lo, hi, [&](const Interval& interval) { overlapping.push_back(&interval); });
+		REQUIRE(overlapping == Expected(lo, hi, false));
+
+		const Interval* const any = eco.FindAnyOverlapping(lo, hi);
+		REQUIRE((any == nullptr) == overlapping.empty());
+		REQUIRE((any == nullptr || std::ranges::find(overlapping, any) != overlapping.end()));
+
+		std::vector<const Interval*> stabbing;
+		eco.Stab(lo, [&](const Interval& interval) { stabbing.push_back(&interval); });
+		REQUIRE(stabbing == Expected(lo, lo, true));
+	}
+};
+
+} // namespace
+
+TEST_CASE("IntervalSet::Insert", "[IntervalSet][Container]")
+{
+	TwoSets sets;
+
+	sets.Insert(0, 10);
+	sets.Insert(5, 6);
+	sets.Insert(5, 20);
+	sets.Insert(12, 15);
+	sets.Insert(30, 30);
+
+	REQUIRE(sets.eco.Size() == 5);
+	REQUIRE(std::ranges::equal(sets.eco, sets.list, [](const Interval& a, const Interval& b) { return &a == &b; }));
+
+	for (int lo = -1; lo <= 31; ++lo)
+	{
+		for (int hi = lo; hi <= 32; ++hi)
+			sets.Check(lo, hi);
+	}
+}
+
+TEST_CASE("IntervalSet mass test.", "[IntervalSet][Container]")
+{
+	TwoSets sets;
+
+	auto rng = Catch::rng();
+	std::uniform_int_distribution<int> loDistribution(0, 1000);
+	std::uniform_int_distribution<int> lengthDistribution(0, 50);
+
+	for (size_t i = 0; i < 2000; ++i)
+	{
+		if (!sets.list.empty() && rng() % 3 == 0)
+		{
+			auto it = sets.list.begin();
+			std::advance(it, rng() % sets.list.size());
+			sets.Remove(it);
+		}
+		else
+		{
+			int const lo = loDistribution(rng);
+			sets.Insert(lo, lo + lengthDistribution(rng));
+		}
+
+		if (i % 100 == 0)
+		{
+			int const lo = loDistribution(rng);
+			sets.Check(lo, lo + lengthDistribution(rng));
+		}
+	}
+
+	REQUIRE(sets.eco.Size() == sets.list.size());
+	REQUIRE(std::ranges::is_sorted(sets.eco, {}, &Interval::lo));
+
+	for (int lo = -10; lo <= 1060; lo += 7)
+		sets.Check(lo, lo + lengthDistribution(rng));
+
+	sets.eco.Clear();
+	REQUIRE(sets.eco.IsEmpty());
+}
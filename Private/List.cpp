@@ -54,7 +54,7 @@ void Core::Adopt(Hook* const head, size_t const size)
 	Eco_Assert(m_size == 0);
 	m_size = size;
 
-	Hook* const tail = m_root.siblings[1];
+	Hook* const tail = head->siblings[1];
 	Eco_Assert(tail->siblings[0] == head);
 
 	m_root.siblings[0] = head;
@@ -66,6 +66,25 @@ void Core::Adopt(Hook* const head, size_t const size)
 	Eco_AssertSlow(Invariant(this));
 }
 
+Hook* Core::Release()
+{
+	if (m_size == 0) return nullptr;
+	m_size = 0;
+
+	Hook* const head = m_root.siblings[0];
+	Hook* const tail = m_root.siblings[1];
+
+	head->siblings[1] = tail;
+	tail->siblings[0] = head;
+
+	m_root.siblings[0] = &m_root;
+	m_root.siblings[1] = &m_root;
+
+	Eco_AssertSlow(Invariant(this));
+
+	return head;
+}
+
 void Core::Insert(Hook* const prev, Hook* const hook, bool const before)
 {
 	LinkInsert(*hook, *this);
@@ -97,3 +116,13 @@ void Core::Remove(Hook* const hook)
 
 	Eco_AssertSlow(Invariant(this));
 }
+
+void Core::Relocate(Hook* const hook, Hook* const newHook)
+{
+	LinkRelocate(*hook, *newHook, *this);
+
+	newHook->siblings[0]->siblings[1] = newHook;
+	newHook->siblings[1]->siblings[0] = newHook;
+
+	Eco_AssertSlow(Invariant(this));
+}
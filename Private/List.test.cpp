@@ -92,6 +92,36 @@ TEST_CASE("List::Remove" "[List][Container]")
 	CHECK(std::ranges::equal(expected, Values(list)));
 }
 
+TEST_CASE("List::Relocate", "[List][Container]")
+{
+	List list;
+	Elements e;
+	Elements moved;
+
+	int const size = GENERATE(1, 2, 5);
+	int const relocate = GENERATE(0, 1, 4);
+
+	Element* elements[5];
+	for (int i = 0; i < size; ++i)
+		list.Append(elements[i] = e(i));
+
+	if (relocate < size)
+	{
+		Element* const element = moved(0);
+		*element = *elements[relocate];
+		list.Relocate(elements[relocate], element);
+		elements[relocate]->value = -1;
+		elements[relocate] = element;
+	}
+
+	CHECK(std::ranges::equal(std::views::iota(0, size), Values(list)));
+	CHECK(std::ranges::equal(std::views::iota(0, size) | std::views::reverse, Values(list) | std::views::reverse));
+
+	for (int i = 0; i < size; ++i)
+		list.Remove(elements[i]);
+	CHECK(list.IsEmpty());
+}
+
 TEST_CASE("List::Remove during iteration.", "[List][Container]")
 {
 	List list;
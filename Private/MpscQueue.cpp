@@ -62,3 +62,37 @@ Hook* Core::TryDequeue()
 
 	return nullptr;
 }
+
+void Core::Relocate(Hook* const hook, Hook* const newHook)
+{
+	LinkRelocate(*hook, *newHook, *this);
+
+	// The dequeue list is owned by the consumer.
+	for (Hook** next = &m_dequeue; *next != nullptr; next = &(*next)->next)
+	{
+		if (*next == hook)
+		{
+			*next = newHook;
+			return;
+		}
+	}
+
+	// Producers only replace the head of the enqueue list.
+	Hook* head = m_enqueue.load(std::memory_order::acquire);
+	while (head == hook)
+	{
+		if (m_enqueue.compare_exchange_weak(head, newHook,
+			std::memory_order::acq_rel, std::memory_order::acquire)) return;
+	}
+
+	for (Hook* prev = head;; prev = prev->next)
+	{
+		Eco_Assert(prev != nullptr);
+
+		if (prev->next == hook)
+		{
+			prev->next = newHook;
+			return;
+		}
+	}
+}
@@ -0,0 +1,69 @@
+#include "Eco/QuantileWindow.hpp"
+
+#include "catch2/catch.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <random>
+#include <vector>
+
+using namespace Eco;
+
+TEST_CASE("QuantileWindow::Insert", "[QuantileWindow][Container]")
+{
+	size_t const capacity = GENERATE(1, 2, 10, 100);
+
+	QuantileWindow<int> window(capacity);
+	std::deque<int> recent;
+
+	auto rng = Catch::rng();
+	std::uniform_int_distribution<int> distribution(0, 50);
+
+	for (size_t i = 0; i < capacity * 5; ++i)
+	{
+		int const value = distribution(rng);
+		window.Insert(value);
+
+		recent.push_back(value);
+		if (recent.size() > capacity)
+			recent.pop_front();
+
+		REQUIRE(window.Size() == recent.size());
+
+		std::vector<int> sorted(recent.begin(), recent.end());
+		std::ranges::sort(sorted);
+
+		for (size_t rank = 0; rank < sorted.size(); ++rank)
+			REQUIRE(window.Select(rank) == sorted[rank]);
+	}
+
+	window.Clear();
+	REQUIRE(window.IsEmpty());
+
+	window.Insert(7);
+	REQUIRE(window.Size() == 1);
+	REQUIRE(window.Select(0) == 7);
+}
+
+TEST_CASE("QuantileWindow::Quantile", "[QuantileWindow][Container]")
+{
+	QuantileWindow<int> window(100);
+
+	// Fill the window twice over with the values 1 to 100 in descending order.
+	for (int i = 0; i < 200; ++i)
+		window.Insert(200 - i > 100 ? 200 - i - 100 : 200 - i);
+
+	REQUIRE(window.Size() == 100);
+	REQUIRE(window.Quantile(0) == 1);
+	REQUIRE(window.Quantile(0.01) == 1);
+	REQUIRE(window.Quantile(0.015) == 2);
+	REQUIRE(window.Quantile(0.5) == 50);
+	REQUIRE(window.Quantile(0.99) == 99);
+	REQUIRE(window.Quantile(0.999) == 100);
+	REQUIRE(window.Quantile(1) == 100);
+
+	QuantileWindow<double, std::compare_three_way> single(1);
+	single.Insert(0.5);
+	REQUIRE(single.Quantile(0) == 0.5);
+	REQUIRE(single.Quantile(1) == 0.5);
+}
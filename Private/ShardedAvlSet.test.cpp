@@ -0,0 +1,171 @@
+#include "Eco/ShardedAvlSet.hpp"
+
+#include "Elements.test.hpp"
+
+#include "catch2/catch.hpp"
+
+#include <ranges>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace Eco;
+
+namespace {
+
+struct ValueSelector
+{
+	int operator()(const Element& element) const
+	{
+		return element.value;
+	}
+};
+
+using Set = ShardedAvlSet<Element, ValueSelector>;
+
+std::vector<int> Values(Set& set)
+{
+	std::vector<int> values;
+	for (Element& element : set)
+		values.push_back(element.value);
+	return values;
+}
+
+} // namespace
+
+TEST_CASE("ShardedAvlSet::Insert", "[ShardedAvlSet][Container]")
+{
+	Elements e;
+
+	auto rng = Catch::rng();
+	std::uniform_int_distribution<int> distribution(0, 10000);
+
+	Set set(16);
+	std::set<int> std;
+
+	for (int i = 0; i < 2000; ++i)
+	{
+		int const value = distribution(rng);
+		REQUIRE(set.Insert(e(value)).Inserted == std.insert(value).second);
+	}
+
+	REQUIRE(set.Size() == std.size());
+	REQUIRE(set.ShardCount() > 1);
+	REQUIRE(std::ranges::equal(std, Values(set)));
+
+	for (int i = 0; i < 1000; ++i)
+	{
+		int const value = distribution(rng);
+		Element* const element = set.Find(value);
+		REQUIRE((element != nullptr) == std.contains(value));
+	}
+}
+
+TEST_CASE("ShardedAvlSet::Remove", "[ShardedAvlSet][Container]")
+{
+	Elements e;
+
+	Set set(16);
+	std::set<int> std;
+
+	for (int i = 0; i < 1000; ++i)
+	{
+		set.Insert(e(i));
+		std.insert(i);
+	}
+
+	size_t const shardCount = set.ShardCount();
+
+	for (int i = 0; i < 1000; ++i)
+	{
+		if (i % 10 != 0)
+		{
+			set.Remove(set.Find(i));
+			std.erase(i);
+		}
+	}
+
+	REQUIRE(set.Size() == std.size());
+	REQUIRE(set.ShardCount() < shardCount);
+	REQUIRE(std::ranges::equal(std, Values(set)));
+}
+
+TEST_CASE("ShardedAvlSet::Insert split at median", "[ShardedAvlSet][Container]")
+{
+	Elements e;
+
+	Set set(16);
+	for (int i = 0; i <= 16; ++i)
+		set.Insert(e(i));
+
+	REQUIRE(set.ShardCount() == 2);
+
+	// The lower shard holds exactly 8 elements, so it is merged after removing 5 of them.
+	for (int i = 0; i < 4; ++i)
+		set.Remove(set.Find(i));
+
+	REQUIRE(set.ShardCount() == 2);
+
+	set.Remove(set.Find(4));
+	REQUIRE(set.ShardCount() == 1);
+	REQUIRE(std::ranges::equal(std::views::iota(5, 17), Values(set)));
+}
+
+TEST_CASE("ShardedAvlSet::Remove merge size", "[ShardedAvlSet][Container]")
+{
+	Elements e;
+
+	Set set(16);
+	for (int i = 0; i <= 16; ++i)
+		set.Insert(e(i));
+
+	REQUIRE(set.ShardCount() == 2);
+
+	// Shards are merged as soon as the smaller one falls below a quarter of the maximum size,
+	// as long as the combined size does not exceed the maximum.
+	int value = 16;
+	while (set.ShardCount() > 1)
+		set.Remove(set.Find(value--));
+
+	REQUIRE(set.Size() > 8);
+	REQUIRE(set.Size() <= 16);
+	REQUIRE(std::ranges::equal(std::views::iota(0, value + 1), Values(set)));
+}
+
+TEST_CASE("ShardedAvlSet concurrent writers", "[ShardedAvlSet][Container]")
+{
+	int const threadCount = 4;
+	int const perThread = 2000;
+
+	std::vector<Element> elements;
+	elements.reserve(threadCount * perThread);
+	for (int i = 0; i < threadCount * perThread; ++i)
+		elements.emplace_back(i);
+
+	Set set(64);
+	{
+		std::vector<std::jthread> threads;
+		for (int t = 0; t < threadCount; ++t)
+		{
+			threads.emplace_back([&, t]
+			{
+				// Interleave the keys of the threads to make them contend for shards.
+				for (int i = 0; i < perThread; ++i)
+					set.Insert(&elements[i * threadCount + t]);
+
+				for (int i = 0; i < perThread; i += 2)
+					set.Remove(&elements[i * threadCount + t]);
+			});
+		}
+	}
+
+	std::vector<int> expected;
+	for (int i = 0; i < threadCount * perThread; ++i)
+	{
+		if (i / threadCount % 2 != 0)
+			expected.push_back(i);
+	}
+
+	REQUIRE(set.Size() == expected.size());
+	REQUIRE(Values(set) == expected);
+}
@@ -0,0 +1,131 @@
+#include "Eco/WbSequence.hpp"
+
+#include "catch2/catch.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace Eco;
+
+namespace {
+
+struct Item : WbSetLink
+{
+	int value;
+};
+
+void Check(const WbSequence<Item>& sequence, const std::vector<Item*>& expected)
+{
+	REQUIRE(sequence.Size() == expected.size());
+	REQUIRE(sequence.IsEmpty() == expected.empty());
+
+	size_t index = 0;
+	for (const Item& item : sequence)
+	{
+		REQUIRE(&item == expected[index]);
+		REQUIRE(sequence.At(index) == expected[index]);
+		REQUIRE(sequence.IndexOf(&item) == index);
+		++index;
+	}
+	REQUIRE(index == expected.size());
+}
+
+} // namespace
+
+TEST_CASE("WbSequence::InsertAt", "[WbSequence][Container]")
+{
+	size_t const count = GENERATE(1, 2, 10, 200);
+
+	std::unique_ptr<Item[]> const items(new Item[count]);
+
+	WbSequence<Item> sequence;
+	std::vector<Item*> expected;
+
+	auto rng = Catch::rng();
+	for (size_t i = 0; i < count; ++i)
+	{
+		items[i].value = static_cast<int>(i);
+
+		size_t const index = std::uniform_int_distribution<size_t>(0, expected.size())(rng);
+		sequence.InsertAt(index, &items[i]);
+		expected.insert(expected.begin() + index, &items[i]);
+	}
+	Check(sequence, expected);
+
+	while (!expected.empty())
+	{
+		size_t const index = std::uniform_int_distribution<size_t>(0, expected.size() - 1)(rng);
+		REQUIRE(sequence.RemoveAt(index) == expected[index]);
+		expected.erase(expected.begin() + index);
+		Check(sequence, expected);
+	}
+}
+
+TEST_CASE("WbSequence::SplitAt", "[WbSequence][Container]")
+{
+	size_t const count = GENERATE(0, 1, 2, 10, 100);
+
+	std::unique_ptr<Item[]> const items(new Item[count]);
+
+	for (size_t index = 0; index <= count; ++index)
+	{
+		WbSequence<Item> sequence;
+		std::vector<Item*> expected;
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			sequence.Append(&items[i]);
+			expected.push_back(&items[i]);
+		}
+
+		WbSequence<Item> upper = sequence.SplitAt(index);
+		Check(sequence, std::vector<Item*>(expected.begin(), expected.begin() + index));
+		Check(upper, std::vector<Item*>(expected.begin() + index, expected.end()));
+
+		sequence.Concat(upper);
+		Check(sequence, expected);
+		Check(upper, {});
+	}
+}
+
+TEST_CASE("WbSequence::Concat", "[WbSequence][Container]")
+{
+	size_t const count = 300;
+
+	std::unique_ptr<Item[]> const items(new Item[count]);
+
+	std::vector<WbSequence<Item>> sequences;
+	std::vector<std::vector<Item*>> expected;
+
+	// Build sequences of various sizes, then concatenate random pairs.
+	auto rng = Catch::rng();
+	for (size_t i = 0; i < count;)
+	{
+		size_t const size = std::min(count - i, std::uniform_int_distribution<size_t>(0, 40)(rng));
+
+		WbSequence<Item>& sequence = sequences.emplace_back();
+		std::vector<Item*>& elements = expected.emplace_back();
+
+		for (size_t j = 0; j < size; ++j, ++i)
+		{
+			sequence.Append(&items[i]);
+			elements.push_back(&items[i]);
+		}
+	}
+
+	while (sequences.size() > 1)
+	{
+		size_t const index = std::uniform_int_distribution<size_t>(0, sequences.size() - 2)(rng);
+
+		sequences[index].Concat(sequences[index + 1]);
+		expected[index].insert(expected[index].end(), expected[index + 1].begin(), expected[index + 1].end());
+
+		Check(sequences[index + 1], {});
+		sequences.erase(sequences.begin() + index + 1);
+		expected.erase(expected.begin() + index + 1);
+
+		Check(sequences[index], expected[index]);
+	}
+}
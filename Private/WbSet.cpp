@@ -94,6 +94,167 @@ static void Rebalance(Hook** const root, Hook** node, bool l, bool const insert)
 	}
 }
 
+static bool Heavy(Hook* const hook, Hook* const other)
+{
+	size_t const weight = Weight(hook);
+	size_t const otherWeight = Weight(other);
+	return weight + otherWeight > 1 && weight >= otherWeight * Delta;
+}
+
+// Make the hook the root of a subtree with the given l and r children.
+static Hook* Attach(Hook* const hook, bool const l, Hook* const lChild, Hook* const rChild)
+{
+	bool const r = !l;
+
+	hook->children[l] = lChild;
+	hook->children[r] = rChild;
+
+	if (lChild != nullptr) lChild->parent = hook->children;
+	if (rChild != nullptr) rChild->parent = hook->children;
+
+	hook->weight = Weight(lChild) + Weight(rChild) + 1;
+	return hook;
+}
+
+// Restore the balance of a subtree whose children are balanced, using a single or double rotation.
+// Returns the new root of the subtree.
+static Hook* Balance(Hook* const hook)
+{
+	bool l;
+	if (Heavy(hook->children[0], hook->children[1])) l = 0;
+	else if (Heavy(hook->children[1], hook->children[0])) l = 1;
+	else return hook;
+
+	bool const r = !l;
+
+	Hook* const lChild = hook->children[l];
+	Hook* const rChild = hook->children[r];
+	Hook* const llChild = lChild->children[l];
+	Hook* const lrChild = lChild->children[r];
+
+	if (Weight(lrChild) >= Weight(llChild) * Ratio)
+	{
+		// The inner grandchild becomes the new subtree root.
+		Hook* const lHook = Balance(Attach(lChild, l, llChild, lrChild->children[l]));
+		Hook* const rHook = Balance(Attach(hook, l, lrChild->children[r], rChild));
+		return Attach(lrChild, l, lHook, rHook);
+	}
+
+	return Attach(lChild, l, llChild, Balance(Attach(hook, l, lrChild, rChild)));
+}
+
+// Join a lighter tree on the r side of a heavier tree on the l side using a hook ordered between them.
+static Hook* JoinHeavy(Hook* const heavy, Hook* const hook, Hook* const light, bool const l)
+{
+	bool const r = !l;
+
+	if (!Heavy(heavy, light))
+		return Balance(Attach(hook, l, heavy, light));
+
+	// Descend along the inner side of the heavier tree.
+	Hook* const inner = JoinHeavy(heavy->children[r], hook, light, l);
+	return Balance(Attach(heavy, l, heavy->children[l], inner));
+}
+
+// Join two trees using a hook ordered between them.
+// Returns the root of the resulting tree, whose parent pointer is not set.
+static Hook* JoinTrees(Hook* const lRoot, Hook* const hook, Hook* const rRoot)
+{
+	if (Heavy(rRoot, lRoot))
+		return JoinHeavy(rRoot, hook, lRoot, 1);
+
+	return JoinHeavy(lRoot, hook, rRoot, 0);
+}
+
+// Split a tree at a hook, which is excluded from both resulting trees.
+// The parent pointers of the resulting roots are not set.
+static void SplitTree(Hook** const root, Hook* const hook, Hook*& lRoot, Hook*& rRoot)
+{
+	lRoot = hook->children[0];
+	rRoot = hook->children[1];
+
+	// Walk up joining each ancestor and its other subtree into either tree.
+	Hook* child = hook;
+	for (Hook** children = hook->parent; children != root;)
+	{
+		Hook* const parent = Eco_WB_HOOK_FROM_CHILDREN(children);
+		Hook** const next = parent->parent;
+
+		if (parent->children[0] == child)
+		{
+			rRoot = JoinTrees(rRoot, parent, parent->children[1]);
+		}
+		else
+		{
+			lRoot = JoinTrees(parent->children[0], parent, lRoot);
+		}
+
+		child = parent;
+		children = next;
+	}
+}
+
+// Link the hooks of a tree to their in-order predecessors through children[0],
+// continuing the chain ending at tail, and reset the root.
+// Returns the new tail of the chain.
+static Hook* ChainTree(Hook** const root, Hook* tail)
+{
+	if (*root == nullptr)
+		return tail;
+
+	// The left subtree of a hook is visited before the hook itself,
+	// so overwriting children[0] does not disturb the traversal.
+	for (Hook* hook = Leftmost(*root, 0); hook != nullptr;)
+	{
+		Hook** const next = IteratorAdvance(hook->children, 0);
+
+		hook->children[0] = tail;
+		tail = hook;
+
+		hook = next != root ? Eco_WB_HOOK_FROM_CHILDREN(next) : nullptr;
+	}
+
+	*root = nullptr;
+	return tail;
+}
+
+// Turn a chain of hooks linked through children[0] into a circular list.
+static Private::List_::Hook* ChainToList(Hook* const tail)
+{
+	if (tail == nullptr)
+		return nullptr;
+
+	Hook* head = nullptr;
+	for (Hook* hook = tail; hook != nullptr;)
+	{
+		Hook* const prev = hook->children[0];
+
+		hook->children[0] = head;
+		hook->children[1] = prev;
+
+		head = hook;
+		hook = prev;
+	}
+
+	head->children[1] = tail;
+	tail->children[0] = head;
+
+	return reinterpret_cast<Private::List_::Hook*>(head);
+}
+
+#if Eco_CONFIG_LINK_DEBUG
+// Transfer the ownership of all hooks in a tree to another container.
+static void Relink(Hook** const root, LinkContainer& src, LinkContainer& dst)
+{
+	for (Hook** children = IteratorBegin(root); children != root; children = IteratorAdvance(children, 0))
+	{
+		Hook* const hook = Eco_WB_HOOK_FROM_CHILDREN(children);
+		LinkRemove(*hook, src);
+		LinkInsert(*hook, dst);
+	}
+}
+#endif
+
 static bool Invariant(const Core* const self)
 {
 	if (const Hook* hook = self->m_root.Value)
@@ -162,7 +323,7 @@ Hook* Core::Select(size_t rank) const
 		if (leftWeight == rank) return hook;
 
 		hook = hook->children[rank > leftWeight];
-		if (rank > leftWeight) rank -= leftWeight;
+		if (rank > leftWeight) rank -= leftWeight + 1;
 	}
 }
 
@@ -170,13 +331,13 @@ size_t Core::Rank(const Hook* hook) const
 {
 	LinkCheck(*hook, *this);
 
-	size_t rank = 0;
+	size_t rank = Weight(hook->children[0]);
 	while (hook->parent != &m_root.Value)
 	{
 		const Hook* const parent = Eco_WB_HOOK_FROM_CHILDREN(hook->parent);
 
 		if (hook != parent->children[0])
-			rank += Weight(parent->children[0]);
+			rank += Weight(parent->children[0]) + 1;
 
 		hook = parent;
 	}
@@ -201,6 +362,26 @@ void Core::Insert(Hook* const hook, Ptr<Hook*> const parentAndSide)
 	Eco_AssertSlow(Invariant(this));
 }
 
+void Core::InsertAt(size_t index, Hook* const hook)
+{
+	Eco_Assert(index <= Weight(m_root.Value));
+
+	Hook** parent = &m_root.Value;
+	bool l = 0;
+
+	while (parent[l] != nullptr)
+	{
+		Hook* const child = parent[l];
+		size_t const leftWeight = Weight(child->children[0]);
+
+		parent = child->children;
+		l = index > leftWeight;
+		if (l) index -= leftWeight + 1;
+	}
+
+	Insert(hook, { parent, l });
+}
+
 void Core::Remove(Hook* const hook)
 {
 	LinkRemove(*hook, *this);
@@ -270,6 +451,19 @@ void Core::Remove(Hook* const hook)
 	Eco_AssertSlow(Invariant(this));
 }
 
+void Core::Relocate(Hook* const hook, Hook* const newHook)
+{
+	LinkRelocate(*hook, *newHook, *this);
+
+	Hook** const parent = newHook->parent;
+	parent[parent[0] != hook] = newHook;
+
+	for (Hook* const child : newHook->children)
+		if (child != nullptr) child->parent = newHook->children;
+
+	Eco_AssertSlow(Invariant(this));
+}
+
 void Core::Clear()
 {
 	if (m_root.Value != nullptr)
@@ -301,54 +495,131 @@ void Core::Clear()
 
 Private::List_::Hook* Core::Flatten()
 {
-	Hook* root = m_root.Value;
+	Hook* const tail = ChainTree(&m_root.Value, nullptr);
 
-	if (root != nullptr)
-	{
-		m_root = nullptr;
+	Eco_AssertSlow(Invariant(this));
 
-		auto const FlattenSide = [](Hook* node, bool const l) -> Hook*
-		{
-			bool const r = !l;
+	return ChainToList(tail);
+}
 
-			while (node->children[l] != nullptr)
-			{
-				// Rotate the whole left subtree right to left turning it into a list.
+Private::List_::Hook* Core::RemoveRange(Hook** const first, Hook** const last, Core& other, size_t& size)
+{
+	Eco_Assert(other.m_root.Value == nullptr);
 
-				Hook* const tail = node->children[l];
-				Hook* head = tail;
+	if (first == last)
+	{
+		size = 0;
+		return nullptr;
+	}
 
-				while (head->children[r] != nullptr)
-				{
-					Hook* const pivot = head->children[r];
+	Hook* const hook = Eco_WB_HOOK_FROM_CHILDREN(first);
+	Hook* const next = last != &m_root.Value ? Eco_WB_HOOK_FROM_CHILDREN(last) : nullptr;
 
-					pivot->children[l] = head;
-					head->children[r] = pivot;
+	Hook* lRoot;
+	Hook* rRoot;
+	SplitTree(&m_root.Value, hook, lRoot, rRoot);
 
-					head = pivot;
-				}
+	// The hooks after the first removed hook and before the next hook are removed.
+	Hook* mRoot = rRoot;
+	if (next != nullptr)
+	{
+		rRoot->parent = &rRoot;
 
-				node->children[l] = head;
-				head->children[r] = node;
+		Hook* nRoot;
+		SplitTree(&rRoot, next, mRoot, nRoot);
+		lRoot = JoinTrees(lRoot, next, nRoot);
+	}
 
-				node = tail;
-			}
+	m_root = lRoot;
+	if (lRoot != nullptr)
+		lRoot->parent = &m_root.Value;
 
-			return node;
-		};
+	if (mRoot != nullptr)
+		mRoot->parent = &mRoot;
 
-		Hook* const head = FlattenSide(root, 0);
-		Hook* const tail = FlattenSide(root, 1);
+	size = Weight(mRoot) + 1;
 
-		head->children[0] = tail;
-		tail->children[1] = head;
+	hook->children[0] = nullptr;
+	Hook* const tail = ChainTree(&mRoot, hook);
 
-		root = head;
+#if Eco_CONFIG_LINK_DEBUG
+	for (Hook* link = tail; link != nullptr; link = link->children[0])
+	{
+		LinkRemove(*link, *this);
+		LinkInsert(*link, other);
 	}
+#endif
 
 	Eco_AssertSlow(Invariant(this));
 
-	return reinterpret_cast<List_::Hook*>(root);
+	return ChainToList(tail);
+}
+
+void Core::SplitAt(size_t const index, Core& other)
+{
+	Eco_Assert(other.m_root.Value == nullptr);
+	Eco_Assert(index <= Weight(m_root.Value));
+
+	if (index == Weight(m_root.Value))
+		return;
+
+	Hook* const hook = Select(index);
+
+	Hook* lRoot;
+	Hook* rRoot;
+	SplitTree(&m_root.Value, hook, lRoot, rRoot);
+
+	m_root = lRoot;
+	if (lRoot != nullptr)
+		lRoot->parent = &m_root.Value;
+
+	// The hook at the index becomes the first hook of the other tree.
+	Hook* const oRoot = JoinTrees(nullptr, hook, rRoot);
+	other.m_root = oRoot;
+	oRoot->parent = &other.m_root.Value;
+
+#if Eco_CONFIG_LINK_DEBUG
+	Relink(&other.m_root.Value, *this, other);
+#endif
+
+	Eco_AssertSlow(Invariant(this));
+	Eco_AssertSlow(Invariant(&other));
+}
+
+void Core::Concat(Core& other)
+{
+	if (other.m_root.Value == nullptr)
+		return;
+
+	if (m_root.Value != nullptr)
+	{
+		// The first hook of the other tree joins the two trees.
+		Hook* const hook = Leftmost(other.m_root.Value, 0);
+		other.Remove(hook);
+		LinkInsert(*hook, *this);
+
+		Hook* const rRoot = other.m_root.Value;
+#if Eco_CONFIG_LINK_DEBUG
+		if (rRoot != nullptr)
+			Relink(&other.m_root.Value, other, *this);
+#endif
+
+		m_root = JoinTrees(m_root.Value, hook, rRoot);
+		other.m_root = nullptr;
+	}
+	else
+	{
+#if Eco_CONFIG_LINK_DEBUG
+		Relink(&other.m_root.Value, other, *this);
+#endif
+
+		m_root = std::exchange(other.m_root.Value, nullptr);
+	}
+
+	m_root.Value->parent = &m_root.Value;
+
+	Eco_AssertSlow(Invariant(this));
+	Eco_AssertSlow(Invariant(&other));
 }
 
 
@@ -367,8 +638,8 @@ Hook** Private::WbSet_::IteratorAdvance(Hook** const children, bool const l)
 
 	Hook* hook = Eco_WB_HOOK_FROM_CHILDREN(children);
 
-	// Iterate through ancestors until the branch where the hook is the left child.
-	while (hook != *hook->parent) hook = Eco_WB_HOOK_FROM_CHILDREN(hook->parent);
+	// Iterate through ancestors until the branch where the hook is the l child.
+	while (hook != hook->parent[l]) hook = Eco_WB_HOOK_FROM_CHILDREN(hook->parent);
 
 	return hook->parent;
 }
@@ -1,10 +1,18 @@
 #include "Eco/WbSet.hpp"
 
 #include "Elements.test.hpp"
+#include "Executors.test.hpp"
 
 #include "catch2/catch.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 using namespace Eco;
 
@@ -20,6 +28,47 @@ struct KeySelector
 
 using Set = WbSet<Element, KeySelector>;
 
+struct StringElement : WbSetKeyPrefixLink
+{
+	std::string value;
+
+	StringElement(std::string value)
+		: value(std::move(value))
+	{
+	}
+};
+
+struct StringKeySelector
+{
+	const std::string& operator()(const StringElement& element) const
+	{
+		return element.value;
+	}
+};
+
+using StringSet = WbSet<StringElement, StringKeySelector, std::compare_three_way, StringKeyPrefix>;
+
+// Random strings sharing long prefixes, so that many comparisons fall back to the full keys.
+std::vector<std::string> MakeStrings(size_t const count)
+{
+	static constexpr std::string_view Prefixes[] = { "", "a", "abcdefg", "abcdefgh", "abcdefghij", "\xff\xfe" };
+
+	auto rng = Catch::rng();
+	std::uniform_int_distribution<size_t> prefixDistribution(0, std::size(Prefixes) - 1);
+	std::uniform_int_distribution<size_t> lengthDistribution(0, 4);
+	std::uniform_int_distribution<int> charDistribution(0, 255);
+
+	std::vector<std::string> strings;
+	for (size_t i = 0; i < count; ++i)
+	{
+		std::string string(Prefixes[prefixDistribution(rng)]);
+		for (size_t length = lengthDistribution(rng); length > 0; --length)
+			string.push_back(static_cast<char>(charDistribution(rng)));
+		strings.push_back(std::move(string));
+	}
+	return strings;
+}
+
 struct TwoSets
 {
 	std::list<Element> list;
@@ -239,6 +288,118 @@ TEST_CASE("WbSet::Remove", "[WbSet][Container]")
 	}
 }
 
+TEST_CASE("WbSet::FindOrPrepare", "[WbSet][Container]")
+{
+	Elements e;
+
+	size_t constructed = 0;
+
+	Set set;
+	std::set<int> std;
+
+	auto rng = Catch::rng();
+	std::uniform_int_distribution<int> distribution(0, 500);
+
+	for (int i = 0; i < 1000; ++i)
+	{
+		int const value = distribution(rng);
+
+		auto const r = set.FindOrPrepare(value);
+		REQUIRE((r.Element == nullptr) == std.insert(value).second);
+
+		if (r.Element == nullptr)
+		{
+			++constructed;
+			set.InsertAt(r.Position, e(value));
+		}
+		else
+		{
+			REQUIRE(r.Element->value == value);
+		}
+	}
+
+	REQUIRE(constructed == std.size());
+	REQUIRE(set.Size() == std.size());
+	REQUIRE(std::ranges::equal(std, Values(set)));
+}
+
+TEST_CASE("WbSet::Flatten", "[WbSet][Container]")
+{
+	Elements e;
+
+	auto rng = Catch::rng();
+	std::uniform_int_distribution distribution = {};
+
+	Set set;
+	std::set<int> std;
+
+	for (size_t i = 0; i < 1000; ++i)
+	{
+		int const value = distribution(rng);
+		if (std.insert(value).second)
+			set.Insert(e(value));
+	}
+
+	List<Element> const list = set.Flatten();
+	REQUIRE(set.IsEmpty());
+	REQUIRE(list.Size() == std.size());
+	REQUIRE(std::ranges::equal(std, Values(list)));
+	REQUIRE(std::ranges::equal(std | std::views::reverse, Values(list) | std::views::reverse));
+}
+
+TEST_CASE("WbSet::RemoveRange", "[WbSet][Container]")
+{
+	Elements e;
+
+	auto rng = Catch::rng();
+	std::uniform_int_distribution<int> distribution(0, 2000);
+
+	Set set;
+	std::set<int> std;
+
+	for (int i = 0; i < 1000; ++i)
+	{
+		int const value = distribution(rng);
+		if (std.insert(value).second)
+			set.Insert(e(value));
+	}
+
+	for (int i = 0; i < 20; ++i)
+	{
+		int lo = distribution(rng);
+		int hi = lo + distribution(rng) / 10;
+
+		std::vector<int> const expected(std.lower_bound(lo), std.lower_bound(hi));
+		std.erase(std.lower_bound(lo), std.lower_bound(hi));
+
+		List<Element> const list = set.RemoveRange(lo, hi);
+		REQUIRE(list.Size() == expected.size());
+		REQUIRE(std::ranges::equal(expected, Values(list)));
+		REQUIRE(std::ranges::equal(expected | std::views::reverse, Values(list) | std::views::reverse));
+
+		REQUIRE(set.Size() == std.size());
+		REQUIRE(std::ranges::equal(std, Values(set)));
+	}
+
+	SECTION("Everything")
+	{
+		List<Element> const list = set.RemoveRange(-1, 2001);
+		REQUIRE(list.Size() == std.size());
+		REQUIRE(set.IsEmpty());
+	}
+
+	SECTION("Modify afterwards")
+	{
+		for (int i = 0; i < 100; ++i)
+		{
+			int const value = distribution(rng);
+			if (std.insert(value).second)
+				set.Insert(e(value));
+		}
+		REQUIRE(std::ranges::equal(std, Values(set)));
+	}
+}
+
 TEST_CASE("WbSet mass test.", "[WbSet][Container]")
 {
 	Elements e;
@@ -259,6 +420,51 @@ TEST_CASE("WbSet mass test.", "[WbSet][Container]")
 	REQUIRE(std::ranges::equal(stdSet, Values(set)));
 }
 
+TEST_CASE("WbSet::Relocate", "[WbSet][Container]")
+{
+	Elements e;
+	Elements moved;
+
+	int const size = GENERATE(1, 2, 3, 10, 1000);
+
+	std::vector<int> values;
+	for (int i = 0; i < size; ++i)
+		values.push_back(i * 2);
+	std::ranges::shuffle(values, Catch::rng());
+
+	Set set;
+	for (int const value : values)
+		set.Insert(e(value));
+
+	// Relocate every other element in insertion order.
+	bool relocate = false;
+	for (Element& element : e.list)
+	{
+		relocate = !relocate;
+		if (relocate)
+		{
+			Element* const newElement = moved(0);
+			*newElement = element;
+			set.Relocate(&element, newElement);
+			element.value = -1;
+		}
+	}
+
+	REQUIRE(set.Size() == static_cast<size_t>(size));
+	REQUIRE(std::ranges::equal(std::views::iota(0, size) | std::views::transform([](int i) { return i * 2; }), Values(set)));
+
+	for (int i = 0; i < size; ++i)
+	{
+		Element* const element = set.Find(i * 2);
+		REQUIRE(element != nullptr);
+		REQUIRE(element->value == i * 2);
+		REQUIRE(set.Insert(e(i * 2 + 1)).Inserted);
+		set.Remove(element);
+	}
+
+	REQUIRE(std::ranges::equal(std::views::iota(0, size) | std::views::transform([](int i) { return i * 2 + 1; }), Values(set)));
+}
+
 TEST_CASE("WbSet::Clear", "[WbSet][Container]")
 {
 	UniqueElements e;
@@ -278,6 +484,354 @@ TEST_CASE("WbSet::Clear", "[WbSet][Container]")
 	REQUIRE(set.IsEmpty());
 }
 
+TEST_CASE("WbSet::FindBatch", "[WbSet][Container]")
+{
+	Elements e;
+
+	int const size = GENERATE(0, 1, 10, 1000);
+	size_t const count = GENERATE(0, 1, 15, 16, 17, 1000);
+
+	Set set;
+	for (int i = 0; i < size; ++i)
+		set.Insert(e(i * 2));
+
+	auto rng = Catch::rng();
+	std::uniform_int_distribution<int> distribution(-1, size * 2);
+
+	std::vector<int> keys;
+	for (size_t i = 0; i < count; ++i)
+		keys.push_back(distribution(rng));
+
+	std::vector<Element*> elements(count);
+	set.FindBatch(keys, elements);
+
+	std::vector<const Element*> constElements(count);
+	std::as_const(set).FindBatch(keys, constElements);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		REQUIRE(elements[i] == set.Find(keys[i]));
+		REQUIRE(constElements[i] == set.Find(keys[i]));
+	}
+}
+
+TEST_CASE("WbSet::LowerBound", "[WbSet][Container]")
+{
+	static_assert(std::ranges::bidirectional_range<decltype(std::declval<Set&>().Range(0, 0))>);
+	static_assert(std::ranges::bidirectional_range<decltype(std::declval<const Set&>().Range(0, 0))>);
+
+	Elements e;
+
+	int const size = GENERATE(0, 1, 2, 3, 10, 100);
+
+	// Insert every other value in random order.
+	std::vector<int> values;
+	for (int i = 0; i < size; ++i)
+		values.push_back(i * 2);
+	std::ranges::shuffle(values, Catch::rng());
+
+	Set set;
+	std::set<int> std;
+	for (int const value : values)
+	{
+		set.Insert(e(value));
+		std.insert(value);
+	}
+
+	auto const toStd = [&](auto const it)
+	{
+		return it == set.end() ? std.end() : std.find(it->value);
+	};
+
+	for (int key = -1; key <= size * 2; ++key)
+	{
+		REQUIRE(toStd(set.LowerBound(key)) == std.lower_bound(key));
+		REQUIRE(toStd(set.UpperBound(key)) == std.upper_bound(key));
+		REQUIRE(toStd(set.LowerBoundEquivalent(static_cast<long>(key))) == std.lower_bound(key));
+		REQUIRE(toStd(set.UpperBoundEquivalent(static_cast<long>(key))) == std.upper_bound(key));
+
+		auto const range = set.EqualRange(key);
+		REQUIRE(std::ranges::distance(range) == static_cast<ptrdiff_t>(std.count(key)));
+		REQUIRE(toStd(range.begin()) == std.lower_bound(key));
+		REQUIRE(std::ranges::equal(Values(range), Values(set.EqualRangeEquivalent(static_cast<long>(key)))));
+	}
+
+	int const lo = GENERATE(-1, 0, 1, 5, 50);
+	int const hi = std::max(lo, GENERATE(0, 1, 6, 51, 300));
+
+	auto const range = set.Range(lo, hi);
+	auto const stdRange = std::ranges::subrange(std.lower_bound(lo), std.lower_bound(hi));
+
+	REQUIRE(std::ranges::equal(stdRange, Values(range)));
+	REQUIRE(std::ranges::equal(stdRange | std::views::reverse, Values(range | std::views::reverse)));
+	REQUIRE(std::ranges::equal(Values(range), Values(set.RangeEquivalent(static_cast<long>(lo), static_cast<long>(hi)))));
+}
+
+TEST_CASE("WbSet key prefix", "[WbSet][Container]")
+{
+	size_t const size = GENERATE(0, 1, 10, 1000);
+
+	std::list<StringElement> storage;
+	std::set<std::string> std;
+
+	StringSet set;
+	for (std::string const& string : MakeStrings(size))
+	{
+		StringElement* const element = &storage.emplace_back(string);
+		auto const r = set.Insert(element);
+		REQUIRE(r.Inserted == std.insert(string).second);
+
+		if (!r.Inserted)
+		{
+			REQUIRE(r.Element->value == string);
+			storage.pop_back();
+		}
+	}
+
+	REQUIRE(set.Size() == std.size());
+	REQUIRE(std::ranges::equal(std, set | std::views::transform(StringKeySelector())));
+
+	std::vector<std::string> const keys = MakeStrings(100);
+	std::vector<StringElement*> elements(keys.size());
+	set.FindBatch(keys, elements);
+
+	for (size_t i = 0; i < keys.size(); ++i)
+	{
+		std::string const& key = keys[i];
+
+		StringElement* const element = set.Find(key);
+		REQUIRE((element != nullptr) == std.contains(key));
+		REQUIRE((element == nullptr || element->value == key));
+		REQUIRE(set.FindEquivalent(std::string_view(key)) == element);
+		REQUIRE(elements[i] == element);
+
+		auto const bound = std.lower_bound(key);
+		auto const it = set.LowerBound(key);
+		REQUIRE((it == set.end()) == (bound == std.end()));
+		REQUIRE((it == set.end() || it->value == *bound));
+	}
+
+	for (auto it = storage.begin(); it != storage.end(); it = storage.erase(it))
+		set.Remove(&*it);
+	REQUIRE(set.IsEmpty());
+}
+
+TEST_CASE("WbSet::RankOfKey", "[WbSet][Container]")
+{
+	Elements e;
+
+	int const size = GENERATE(0, 1, 2, 3, 10, 100);
+
+	// Insert every other value in random order.
+	std::vector<int> values;
+	for (int i = 0; i < size; ++i)
+		values.push_back(i * 2);
+	std::ranges::shuffle(values, Catch::rng());
+
+	Set set;
+	for (int const value : values)
+		set.Insert(e(value));
+
+	for (int i = 0; i < size; ++i)
+	{
+		Element* const element = set.Select(static_cast<size_t>(i));
+		REQUIRE(element->value == i * 2);
+		REQUIRE(set.Rank(element) == static_cast<size_t>(i));
+	}
+
+	// Number of inserted values ordered before the key.
+	auto const rank = [&](int const key)
+	{
+		return static_cast<size_t>(std::clamp((key + 1) / 2, 0, size));
+	};
+
+	for (int key = -1; key <= size * 2; ++key)
+	{
+		REQUIRE(set.RankOfKey(key) == rank(key));
+		REQUIRE(set.RankOfKeyEquivalent(static_cast<long>(key)) == rank(key));
+
+		for (int hi = key; hi <= size * 2 + 1; ++hi)
+		{
+			REQUIRE(set.CountRange(key, hi) == rank(hi) - rank(key));
+			REQUIRE(set.CountRangeEquivalent(static_cast<long>(key), static_cast<long>(hi)) == rank(hi) - rank(key));
+		}
+	}
+}
+
+TEST_CASE("WbSet::SampleUniform", "[WbSet][Container]")
+{
+	Elements e;
+
+	int const size = GENERATE(1, 2, 10, 100);
+	size_t const usize = static_cast<size_t>(size);
+
+	Set set;
+	for (int i = 0; i < size; ++i)
+		set.Insert(e(i));
+
+	auto rng = Catch::rng();
+
+	std::vector<size_t> counts(usize);
+	size_t const samples = usize * 1000;
+	for (size_t i = 0; i < samples; ++i)
+		++counts[static_cast<size_t>(set.SampleUniform(rng)->value)];
+
+	for (size_t const count : counts)
+		REQUIRE(static_cast<double>(count) / samples == Approx(1.0 / size).margin(0.01));
+}
+
+TEST_CASE("WbSet::SampleK", "[WbSet][Container]")
+{
+	Elements e;
+
+	int const size = GENERATE(0, 1, 2, 10, 100);
+	size_t const usize = static_cast<size_t>(size);
+
+	Set set;
+	for (int i = 0; i < size; ++i)
+		set.Insert(e(i));
+
+	auto rng = Catch::rng();
+
+	for (size_t k = 0; k <= usize; ++k)
+	{
+		std::vector<size_t> counts(usize);
+		for (int j = 0; j < 100; ++j)
+		{
+			std::vector<const Element*> elements(k);
+			std::as_const(set).SampleK(std::span(elements), rng);
+
+			// The samples are distinct and in order.
+			for (size_t i = 1; i < k; ++i)
+				REQUIRE(elements[i - 1]->value < elements[i]->value);
+
+			for (const Element* const element : elements)
+				++counts[static_cast<size_t>(element->value)];
+		}
+
+		if (k == usize)
+			REQUIRE(std::ranges::all_of(counts, [](size_t const count) { return count == 100; }));
+	}
+
+	if (size > 0)
+	{
+		// Each element is sampled with probability k / n.
+		size_t const k = usize / 2 + 1;
+		std::vector<size_t> counts(usize);
+		std::vector<Element*> elements(k);
+
+		size_t const rounds = 20000;
+		for (size_t j = 0; j < rounds; ++j)
+		{
+			set.SampleK(std::span(elements), rng);
+			for (Element* const element : elements)
+				++counts[static_cast<size_t>(element->value)];
+		}
+
+		for (size_t const count : counts)
+			REQUIRE(static_cast<double>(count) / rounds == Approx(static_cast<double>(k) / size).margin(0.03));
+	}
+}
+
+TEST_CASE("WbSet::SampleK sparse", "[WbSet][Container]")
+{
+	Elements e;
+
+	// Few samples from a large set are drawn by rejection rather than by walking the ranks.
+	size_t const size = 1000;
+	size_t const k = 4;
+
+	Set set;
+	for (int i = 0; i < static_cast<int>(size); ++i)
+		set.Insert(e(i));
+
+	auto rng = Catch::rng();
+
+	std::vector<size_t> counts(size);
+	std::vector<Element*> elements(k);
+
+	// Each element is expected to be sampled 100 times.
+	size_t const rounds = 25000;
+	for (size_t j = 0; j < rounds; ++j)
+	{
+		set.SampleK(std::span(elements), rng);
+
+		for (size_t i = 1; i < k; ++i)
+			REQUIRE(elements[i - 1]->value < elements[i]->value);
+
+		for (Element* const element : elements)
+			++counts[static_cast<size_t>(element->value)];
+	}
+
+	for (size_t const count : counts)
+	{
+		REQUIRE(count > 50);
+		REQUIRE(count < 150);
+	}
+}
+
+TEST_CASE("WbSet::Partition", "[WbSet][Container]")
+{
+	Elements e;
+
+	int const size = GENERATE(0, 1, 2, 3, 10, 1000);
+	size_t const usize = static_cast<size_t>(size);
+
+	// Skewed keys do not affect the sizes of the ranges.
+	Set set;
+	for (int i = 0; i < size; ++i)
+		set.Insert(e(i * i));
+
+	SECTION("Ranges")
+	{
+		size_t const count = GENERATE(1, 2, 3, 7, 16);
+
+		std::vector<std::ranges::subrange<Set::iterator>> ranges(count);
+		set.Partition(ranges);
+
+		REQUIRE(ranges.front().begin() == set.begin());
+		REQUIRE(ranges.back().end() == set.end());
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			size_t const rangeSize = static_cast<size_t>(std::ranges::distance(ranges[i]));
+			REQUIRE(rangeSize >= usize / count);
+			REQUIRE(rangeSize <= (usize + count - 1) / count);
+
+			if (i > 0)
+				REQUIRE(ranges[i].begin() == ranges[i - 1].end());
+		}
+
+		std::vector<std::ranges::subrange<Set::const_iterator>> constRanges(count);
+		std::as_const(set).Partition(constRanges);
+
+		for (size_t i = 0; i < count; ++i)
+			REQUIRE(std::ranges::distance(constRanges[i]) == std::ranges::distance(ranges[i]));
+	}
+
+	SECTION("ParallelForEach")
+	{
+		std::vector<std::atomic<int>> counts(usize);
+		auto const visit = [&](const Element& element)
+		{
+			size_t const index = static_cast<size_t>(std::lround(std::sqrt(element.value)));
+			counts[index].fetch_add(1, std::memory_order_relaxed);
+		};
+
+		SECTION("Mutable")
+		{
+			set.ParallelForEach(ThreadExecutor(), visit);
+		}
+
+		SECTION("Const")
+		{
+			std::as_const(set).ParallelForEach(ThreadExecutor(), visit);
+		}
+
+		REQUIRE(std::ranges::all_of(counts, [](const std::atomic<int>& count) { return count == 1; }));
+	}
+}
+
 TEST_CASE("WbSet iteration.", "[WbSet][Container]")
 {
 	Elements e;
@@ -286,6 +840,7 @@ TEST_CASE("WbSet iteration.", "[WbSet][Container]")
 
 	for (int i : std::views::iota(1, 100) | std::views::reverse) set.Insert(e(i));
 	REQUIRE(std::ranges::equal(std::views::iota(1, 100), Values(set)));
+	REQUIRE(std::ranges::equal(std::views::iota(1, 100) | std::views::reverse, Values(set) | std::views::reverse));
 }
 
 } // namespace
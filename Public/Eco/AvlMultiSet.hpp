@@ -0,0 +1,347 @@
+#pragma once
+
+#include "Eco/AvlSet.hpp"
+
+namespace Eco {
+// inline namespace Eco_NS {
+
+namespace Private::AvlSet_ {
+
+#define Eco_AVL_HOOK(element) \
+	(reinterpret_cast<Hook*>(static_cast<AvlSetLink*>(element)))
+
+#define Eco_AVL_ELEM(hook) \
+	(static_cast<T*>(reinterpret_cast<AvlSetLink*>(hook)))
+
+/// @brief Ordered set allowing multiple elements with equivalent keys.
+/// Elements with equivalent keys are kept in insertion order.
+template<std::derived_from<AvlSetLink> T,
+	KeySelector<T> TKeySelector = IdentityKeySelector,
+	typename TComparator = std::compare_three_way>
+class AvlMultiSet : Core
+{
+	using KeyType = decltype(std::declval<const TKeySelector&>()(std::declval<const T&>()));
+	using RootType = Ptr<Hook>;
+
+	Eco_NO_UNIQUE_ADDRESS TKeySelector m_keySelector;
+	Eco_NO_UNIQUE_ADDRESS TComparator m_comparator;
+
+public:
+	using ElementType = T;
+
+	using       iterator = Iterator<      T>;
+	using const_iterator = Iterator<const T>;
+
+
+	AvlMultiSet() = default;
+
+	explicit AvlMultiSet(TKeySelector keySelector)
+		: m_keySelector(static_cast<TKeySelector&&>(keySelector))
+	{
+	}
+
+	explicit AvlMultiSet(TComparator comparator)
+		: m_comparator(static_cast<TComparator&&>(comparator))
+	{
+	}
+
+	explicit AvlMultiSet(TKeySelector keySelector, TComparator comparator)
+		: m_keySelector(static_cast<TKeySelector&&>(keySelector))
+		, m_comparator(static_cast<TComparator&&>(comparator))
+	{
+	}
+
+	AvlMultiSet(AvlMultiSet&& src) noexcept = default;
+
+	AvlMultiSet& operator=(AvlMultiSet&& src) noexcept
+	{
+		if (!m_root->IsZero())
+			Core::Clear();
+		Core::operator=(static_cast<Core&&>(src));
+		return *this;
+	}
+
+	~AvlMultiSet()
+	{
+		if (!m_root->IsZero())
+			Core::Clear();
+	}
+
+
+	/// @return Size of the set.
+	[[nodiscard]] size_t Size() const
+	{
+		return m_size.Value;
+	}
+
+	/// @return True if the set is empty.
+	[[nodiscard]] bool IsEmpty() const
+	{
+		return m_size.Value == 0;
+	}
+
+
+	/// @brief Find the first inserted element with a homogeneous key.
+	/// @param key Lookup key.
+	/// @return Pointer to element, or null if not found.
+	[[nodiscard]] T* Find(const KeyType& key)
+	{
+		return FindInternal(key);
+	}
+
+	/// @brief Find the first inserted element with a homogeneous key.
+	/// @param key Lookup key.
+	/// @return Pointer to element, or null if not found.
+	[[nodiscard]] const T* Find(const KeyType& key) const
+	{
+		return FindInternal(key);
+	}
+
+	/// @brief Find the first inserted element with a heterogeneous key.
+	/// @param key Lookup key.
+	/// @return Pointer to element or null.
+	template<typename TKey>
+	[[nodiscard]] T* FindEquivalent(const TKey& key)
+		requires (requires (const KeyType& containerKey) { m_comparator(key, containerKey); })
+	{
+		return FindInternal(key);
+	}
+
+	/// @brief Find the first inserted element with a heterogeneous key.
+	/// @param key Lookup key.
+	/// @return Pointer to element or null.
+	template<typename TKey>
+	[[nodiscard]] const T* FindEquivalent(const TKey& key) const
+		requires (requires (const KeyType& containerKey) { m_comparator(key, containerKey); })
+	{
+		return FindInternal(key);
+	}
+
+	/// @brief Count the elements with keys equivalent to a key in O(log n + k) time.
+	/// @param key Lookup key.
+	[[nodiscard]] size_t Count(const KeyType& key) const
+	{
+		return CountInternal(key);
+	}
+
+	/// @brief Count the elements with keys equivalent to a heterogeneous key in O(log n + k) time.
+	/// @param key Lookup key.
+	template<typename TKey>
+	[[nodiscard]] size_t CountEquivalent(const TKey& key) const
+		requires (requires (const KeyType& containerKey) { m_comparator(key, containerKey); })
+	{
+		return CountInternal(key);
+	}
+
+
+	/// @brief Find the first element whose key is not ordered before a key.
+	/// @param key Lookup key.
+	/// @return Iterator referring to the element, or the end iterator.
+	[[nodiscard]] iterator LowerBound(const KeyType& key)
+	{
+		return iterator(BoundInternal(key, false));
+	}
+
+	/// @brief Find the first element whose key is not ordered before a key.
+	/// @param key Lookup key.
+	/// @return Iterator referring to the element, or the end iterator.
+	[[nodiscard]] const_iterator LowerBound(const KeyType& key) const
+	{
+		return const_iterator(BoundInternal(key, false));
+	}
+
+	/// @brief Find the first element whose key is ordered after a key.
+	/// @param key Lookup key.
+	/// @return Iterator referring to the element, or the end iterator.
+	[[nodiscard]] iterator UpperBound(const KeyType& key)
+	{
+		return iterator(BoundInternal(key, true));
+	}
+
+	/// @brief Find the first element whose key is ordered after a key.
+	/// @param key Lookup key.
+	/// @return Iterator referring to the element, or the end iterator.
+	[[nodiscard]] const_iterator UpperBound(const KeyType& key) const
+	{
+		return const_iterator(BoundInternal(key, true));
+	}
+
+	/// @brief Find the range of elements with keys equivalent to a key.
+	/// @param key Lookup key.
+	/// @return Range of the matching elements in insertion order.
+	[[nodiscard]] std::ranges::subrange<iterator> EqualRange(const KeyType& key)
+	{
+		return { iterator(BoundInternal(key, false)), iterator(BoundInternal(key, true)) };
+	}
+
+	/// @brief Find the range of elements with keys equivalent to a key.
+	/// @param key Lookup key.
+	/// @return Range of the matching elements in insertion order.
+	[[nodiscard]] std::ranges::subrange<const_iterator> EqualRange(const KeyType& key) const
+	{
+		return { const_iterator(BoundInternal(key, false)), const_iterator(BoundInternal(key, true)) };
+	}
+
+	/// @brief Find the range of elements with keys equivalent to a heterogeneous key.
+	/// @param key Lookup key.
+	/// @return Range of the matching elements in insertion order.
+	template<typename TKey>
+	[[nodiscard]] std::ranges::subrange<iterator> EqualRangeEquivalent(const TKey& key)
+		requires (requires (const KeyType& containerKey) { m_comparator(key, containerKey); })
+	{
+		return { iterator(BoundInternal(key, false)), iterator(BoundInternal(key, true)) };
+	}
+
+	/// @brief Find the range of elements with keys equivalent to a heterogeneous key.
+	/// @param key Lookup key.
+	/// @return Range of the matching elements in insertion order.
+	template<typename TKey>
+	[[nodiscard]] std::ranges::subrange<const_iterator> EqualRangeEquivalent(const TKey& key) const
+		requires (requires (const KeyType& containerKey) { m_comparator(key, containerKey); })
+	{
+		return { const_iterator(BoundInternal(key, false)), const_iterator(BoundInternal(key, true)) };
+	}
+
+
+	/// @brief Insert new element into the tree after any elements with equivalent keys.
+	/// @param element Element to be inserted.
+	/// @pre @p element is not part of any container.
+	void Insert(T* const element)
+	{
+		auto&& key = m_keySelector(*element);
+
+		Ptr<Hook>* parent = &m_root.Value;
+		uintptr_t l = 0;
+
+		while (!parent[l].IsZero())
+		{
+			Hook* const child = parent[l].Ptr();
+
+			parent = child->children;
+			l = m_comparator(key, m_keySelector(*Eco_AVL_ELEM(child))) >= 0;
+		}
+
+		Core::Insert(Eco_AVL_HOOK(element), { parent, l }, nullptr);
+	}
+
+	/// @brief Remove an element from the tree.
+	/// @param element Element to be removed.
+	/// @pre @p element is part of this tree.
+	void Remove(T* const element)
+	{
+		Core::Remove(Eco_AVL_HOOK(element), nullptr);
+	}
+
+	/// @brief Remove all elements from the tree.
+	using Core::Clear;
+
+
+	/// @brief Create an iterator referring to an element.
+	/// @pram element Element to which the resulting iterator shall refer.
+	/// @pre @p element is part of this tree.
+	[[nodiscard]] iterator MakeIterator(T* const element)
+	{
+		LinkCheck(*element, *this);
+		return iterator(Eco_AVL_HOOK(element));
+	}
+
+	/// @brief Create an iterator referring to an element.
+	/// @pram element Element to which the resulting iterator shall refer.
+	/// @pre @p element is part of this tree.
+	[[nodiscard]] const_iterator MakeIterator(const T* const element) const
+	{
+		LinkCheck(*element, *this);
+		return const_iterator(Eco_AVL_HOOK(const_cast<T*>(element)));
+	}
+
+
+	[[nodiscard]] iterator begin()
+	{
+		return iterator(IteratorBegin(&m_root.Value));
+	}
+
+	[[nodiscard]] const_iterator begin() const
+	{
+		return const_iterator(IteratorBegin(const_cast<RootType*>(&m_root.Value)));
+	}
+
+	[[nodiscard]] iterator end()
+	{
+		return iterator(&m_root.Value);
+	}
+
+	[[nodiscard]] const_iterator end() const
+	{
+		return const_iterator(const_cast<RootType*>(&m_root.Value));
+	}
+
+
+	[[nodiscard]] friend size_t size(const AvlMultiSet& set)
+	{
+		return set.Size();
+	}
+
+	friend void swap(AvlMultiSet& lhs, AvlMultiSet& rhs) noexcept
+	{
+		using std::swap;
+		swap(static_cast<Core&>(lhs), static_cast<Core&>(rhs));
+		swap(lhs.m_keySelector, rhs.m_keySelector);
+		swap(lhs.m_comparator, rhs.m_comparator);
+	}
+
+private:
+	// Find the first hook whose key is ordered after the key, or equivalent to it unless upper.
+	// Returns the children of the hook, or the root pointer if there is none.
+	template<typename TKey>
+	RootType* BoundInternal(const TKey& key, bool const upper) const
+	{
+		RootType* bound = const_cast<RootType*>(&m_root.Value);
+		Hook* hook = m_root->Ptr();
+
+		while (hook != nullptr)
+		{
+			auto const ordering = m_comparator(key, m_keySelector(*Eco_AVL_ELEM(hook)));
+
+			bool const r = upper ? ordering >= 0 : ordering > 0;
+			if (!r) bound = hook->children;
+			hook = hook->children[r].Ptr();
+		}
+
+		return bound;
+	}
+
+	template<typename TKey>
+	T* FindInternal(const TKey& key) const
+	{
+		RootType* const bound = BoundInternal(key, false);
+		if (bound == &m_root.Value) return nullptr;
+
+		T* const element = Eco_AVL_ELEM(Eco_AVL_HOOK_FROM_CHILDREN(bound));
+		return m_comparator(key, m_keySelector(*element)) == 0 ? element : nullptr;
+	}
+
+	template<typename TKey>
+	size_t CountInternal(const TKey& key) const
+	{
+		RootType* const end = const_cast<RootType*>(&m_root.Value);
+
+		size_t count = 0;
+		for (RootType* children = BoundInternal(key, false); children != end; children = IteratorAdvance(children, 0))
+		{
+			T* const element = Eco_AVL_ELEM(Eco_AVL_HOOK_FROM_CHILDREN(children));
+			if (m_comparator(key, m_keySelector(*element)) != 0) break;
+			++count;
+		}
+		return count;
+	}
+};
+
+#undef Eco_AVL_HOOK
+#undef Eco_AVL_ELEM
+
+} // namespace Private::AvlSet_
+
+using Private::AvlSet_::AvlMultiSet;
+
+// } // inline namespace Eco_NS
+} // namespace Eco
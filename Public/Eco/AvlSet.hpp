@@ -3,16 +3,25 @@
 #define Eco_AVL_DEBUG 0
 
 #include "Eco/Attributes.hpp"
+#include "Eco/Executor.hpp"
 #include "Eco/InsertResult.hpp"
+#include "Eco/KeyPrefix.hpp"
 #include "Eco/KeySelector.hpp"
 #include "Eco/Linear.hpp"
 #include "Eco/Link.hpp"
 #include "Eco/List.hpp"
+#include "Eco/Private/Config.hpp"
 #include "Eco/TaggedPointer.hpp"
 
+#include <atomic>
 #include <bit>
 #include <concepts>
+#include <iterator>
+#include <random>
 #include <ranges>
+#include <span>
+
+#include <cstdint>
 
 #if Eco_AVL_DEBUG
 #	include <format>
@@ -24,6 +33,9 @@ namespace Eco {
 
 using AvlSetLink = Link<3>;
 
+/// @brief Link required by @ref AvlSet when caching key prefixes.
+using AvlSetKeyPrefixLink = Link<3 + Private::KeyPrefixLinkSize>;
+
 namespace Private::AvlSet_ {
 
 #define Eco_AVL_HOOK(element) \
@@ -51,11 +63,30 @@ struct HookContent
 
 struct Hook : LinkBase, HookContent {};
 
+// Hook followed by the cached prefix of the key of its element.
+struct KeyPrefixHook : Hook
+{
+	KeyPrefixStorage prefix;
+};
+
+static_assert(sizeof(KeyPrefixHook) == sizeof(AvlSetKeyPrefixLink));
+
+
+// Three-way comparison of the keys of two hooks, returning the sign of the result.
+typedef int Comparator(const struct Core* self, Hook* lhs, Hook* rhs);
+
+// Recompute the augmentation of a hook from its own element and its children.
+typedef void Augment(Hook* hook);
 
 struct Core : LinkContainer
 {
+	// Marks a size which is not known until the tree is counted, such as after splitting.
+	static constexpr size_t UnknownSize = static_cast<size_t>(-1);
+
 	Linear<Ptr<Hook>, nullptr> m_root;
-	Linear<size_t> m_size;
+
+	// Counted lazily when unknown, which may happen in const member functions.
+	mutable Linear<size_t> m_size;
 
 #if Eco_AVL_DEBUG
 	void(*debugPrint)(Core* core, bool nums);
@@ -67,10 +98,87 @@ struct Core : LinkContainer
 		Ptr<const Ptr<Hook>> parent;
 	};
 
-	void Insert(Hook* hook, Ptr<Ptr<Hook>> parentAndSide);
-	void Remove(Hook* hook);
+	// Maximum depth of the top levels of the tree divided by Divide.
+	static constexpr size_t MaxDivideDepth = 6;
+
+	// The tree divided into disjoint subtrees along its top levels.
+	struct Division
+	{
+		size_t count;
+
+		// Possibly empty subtrees in order.
+		Hook* subtrees[size_t(1) << MaxDivideDepth];
+
+		// Hooks ordered between each subtree and the next.
+		Hook* pivots[(size_t(1) << MaxDivideDepth) - 1];
+	};
+
+	Core() = default;
+
+	Core(Core&& src) noexcept
+		: LinkContainer(static_cast<LinkContainer&&>(src))
+		, m_root(static_cast<decltype(m_root)&&>(src.m_root))
+		, m_size(static_cast<decltype(m_size)&&>(src.m_size))
+	{
+		AttachRoot();
+	}
+
+	Core& operator=(Core&& src) noexcept
+	{
+		LinkContainer::operator=(static_cast<LinkContainer&&>(src));
+		m_root = static_cast<decltype(m_root)&&>(src.m_root);
+		m_size = static_cast<decltype(m_size)&&>(src.m_size);
+		AttachRoot();
+		return *this;
+	}
+
+	struct HintResult
+	{
+		Hook* prev;
+		Ptr<Ptr<Hook>> parent;
+	};
+
+	HintResult FindHint(Hook* next);
+
+	void Insert(Hook* hook, Ptr<Ptr<Hook>> parentAndSide, Augment* augment);
+	void Remove(Hook* hook, Augment* augment);
+	void Relocate(Hook* hook, Hook* newHook);
 	void Clear();
+	void Build(List_::Hook* list, size_t size, Augment* augment);
 	List_::Hook* Flatten();
+	List_::Hook* RemoveRange(Ptr<Hook>* first, Ptr<Hook>* last, Core& other, Augment* augment);
+
+	void Split(Hook* hook, Ptr<Ptr<Hook>> parentAndSide, Core& other, Augment* augment);
+	void Join(Core& other, bool after, Augment* augment);
+
+	void Union(Core& other, Comparator* comparator, Augment* augment, const ExecutorRef* executor);
+	void Divide(Division& division, const ExecutorRef& executor) const;
+	void Filter(const Core& other, bool contained, Core& removed,
+		Comparator* comparator, Augment* augment, const ExecutorRef* executor);
+
+	// The root hook refers back to m_root, which must be restored after moving.
+	void AttachRoot()
+	{
+		if (Hook* const root = m_root->Ptr())
+			root->parent = &m_root.Value;
+	}
+
+	// Returns the size of the tree, counting it in linear time if it is unknown.
+	// The count is cached using relaxed atomics, so that concurrent const calls do not race.
+	size_t GetSize() const
+	{
+		std::atomic_ref<size_t> const cache(m_size.Value);
+
+		size_t size = cache.load(std::memory_order_relaxed);
+		if (size == UnknownSize)
+		{
+			size = CountSize();
+			cache.store(size, std::memory_order_relaxed);
+		}
+		return size;
+	}
+
+	size_t CountSize() const;
 
 	friend void swap(Core& lhs, Core& rhs) noexcept
 	{
@@ -78,6 +186,8 @@ struct Core : LinkContainer
 		swap(static_cast<LinkContainer&>(lhs), static_cast<LinkContainer&>(rhs));
 		swap(lhs.m_root, rhs.m_root);
 		swap(lhs.m_size, rhs.m_size);
+		lhs.AttachRoot();
+		rhs.AttachRoot();
 	}
 };
 
@@ -166,14 +276,51 @@ struct Iterator : IteratorCore
 };
 
 
+/// @brief Physical order of the elements produced by @ref AvlSet::CompactLayout.
+enum class AvlSetLayout
+{
+	/// @brief Elements in key order, for scanning.
+	InOrder,
+
+	/// @brief Elements level by level from the root, for lookups.
+	BreadthFirst,
+};
+
+/// @brief Augmentation policy which maintains no aggregates.
+struct NoAugment {};
+
+/// @brief Augmentation policy maintaining an aggregate of each subtree in its root element.
+/// @c Value returns the contribution of a single element, and @c Aggregate the storage for the
+/// aggregate of the subtree rooted at an element. @c Combine must be associative with @c Identity
+/// as its identity element, but need not be commutative.
+template<typename TAugment, typename T>
+concept AvlSetAugment = std::is_same_v<TAugment, NoAugment> ||
+	requires (T& element, const T& constElement, const typename TAugment::ValueType& value)
+	{
+		{ TAugment::Identity() } -> std::convertible_to<typename TAugment::ValueType>;
+		{ TAugment::Value(constElement) } -> std::convertible_to<typename TAugment::ValueType>;
+		{ TAugment::Combine(value, value) } -> std::convertible_to<typename TAugment::ValueType>;
+		{ TAugment::Aggregate(element) } -> std::same_as<typename TAugment::ValueType&>;
+	};
+
 template<std::derived_from<AvlSetLink> T,
 	KeySelector<T> TKeySelector = IdentityKeySelector,
-	typename TComparator = std::compare_three_way>
+	typename TComparator = std::compare_three_way,
+	AvlSetAugment<T> TAugment = NoAugment,
+	KeyPrefixPolicy<std::remove_cvref_t<decltype(std::declval<const TKeySelector&>()(std::declval<const T&>()))>> TKeyPrefix = NoKeyPrefix>
+	requires std::is_same_v<TKeyPrefix, NoKeyPrefix> || std::derived_from<T, AvlSetKeyPrefixLink>
 class AvlSet : Core
 {
 	using KeyType = decltype(std::declval<const TKeySelector&>()(std::declval<const T&>()));
 	using RootType = Ptr<Hook>;
 
+	static constexpr bool HasKeyPrefix = !std::is_same_v<TKeyPrefix, NoKeyPrefix>;
+
+	// Heterogeneous keys not accepted by the key prefix policy are compared without prefixes.
+	template<typename TKey>
+	static constexpr bool UsesKeyPrefix = HasKeyPrefix &&
+		requires (const TKey& key) { TKeyPrefix::Prefix(key); };
+
 	Eco_NO_UNIQUE_ADDRESS TKeySelector m_keySelector;
 	Eco_NO_UNIQUE_ADDRESS TComparator m_comparator;
 
@@ -189,6 +336,31 @@ public:
 
 	using InsertResult = Eco::InsertResult<T>;
 
+	/// @brief Opaque position in the tree at which a new element may be inserted.
+	class InsertPosition
+	{
+		Ptr<Ptr<Hook>> m_parent;
+
+		explicit InsertPosition(Ptr<Ptr<Hook>> const parent)
+			: m_parent(parent)
+		{
+		}
+
+		friend AvlSet;
+
+	public:
+		InsertPosition() = default;
+	};
+
+	struct PrepareResult
+	{
+		/// @brief Matching element in the container, or null if there is none.
+		T* Element;
+
+		/// @brief Position at which an element with the key may be inserted if there is no match.
+		InsertPosition Position;
+	};
+
 
 #if Eco_AVL_DEBUG
 	AvlSet()
@@ -217,6 +389,8 @@ public:
 	{
 	}
 
+	AvlSet(AvlSet&& src) noexcept = default;
+
 	AvlSet& operator=(AvlSet&& src) noexcept
 	{
 		if (!m_root->IsZero())
@@ -233,15 +407,37 @@ public:
 
 
 	/// @return Size of the set.
+	/// @note After @ref Split, the sizes of both sets are counted in linear time the first time they are needed.
 	[[nodiscard]] size_t Size() const
 	{
-		return m_size.Value;
+		return Core::GetSize();
 	}
 
 	/// @return True if the set is empty.
 	[[nodiscard]] bool IsEmpty() const
 	{
-		return m_size.Value == 0;
+		return m_root->IsZero();
+	}
+
+
+	/// @return Element at the root of the tree.
+	/// @note The balance of an AVL tree does not guarantee an even division of the elements
+	/// by the root. Either subtree may hold only a small fraction of the elements.
+	/// @pre The set is not empty.
+	[[nodiscard]] T* Root()
+	{
+		Eco_Assert(!m_root->IsZero());
+		return Eco_AVL_ELEM(m_root->Ptr());
+	}
+
+	/// @return Element at the root of the tree.
+	/// @note The balance of an AVL tree does not guarantee an even division of the elements
+	/// by the root. Either subtree may hold only a small fraction of the elements.
+	/// @pre The set is not empty.
+	[[nodiscard]] const T* Root() const
+	{
+		Eco_Assert(!m_root->IsZero());
+		return Eco_AVL_ELEM(m_root->Ptr());
 	}
 
 
@@ -281,6 +477,274 @@ public:
 		return Eco_AVL_ELEM(FindInternal(key).hook);
 	}
 
+	/// @return Aggregate of all elements in the set.
+	[[nodiscard]] auto Aggregate() const
+		requires (!std::is_same_v<TAugment, NoAugment>)
+	{
+		return SubtreeAggregate(m_root->Ptr());
+	}
+
+	/// @brief Compute the aggregate of the elements with keys in [lo, hi) in logarithmic time.
+	/// @param lo Inclusive lower bound.
+	/// @param hi Exclusive upper bound.
+	/// @return Aggregate of the elements in key order.
+	[[nodiscard]] auto Aggregate(const KeyType& lo, const KeyType& hi) const
+		requires (!std::is_same_v<TAugment, NoAugment>)
+	{
+		using ValueType = typename TAugment::ValueType;
+
+		// Find the highest hook within the interval, where the searches for the bounds diverge.
+		Hook* split = m_root->Ptr();
+		while (split != nullptr)
+		{
+			auto&& key = m_keySelector(*Eco_AVL_ELEM(split));
+
+			if (m_comparator(lo, key) > 0)
+				split = split->children[1].Ptr();
+			else if (m_comparator(hi, key) <= 0)
+				split = split->children[0].Ptr();
+			else
+				break;
+		}
+
+		if (split == nullptr)
+			return static_cast<ValueType>(TAugment::Identity());
+
+		// Along the search for lo, each hook not ordered before lo is followed by its right subtree.
+		ValueType lAggregate = TAugment::Identity();
+		for (Hook* hook = split->children[0].Ptr(); hook != nullptr;)
+		{
+			if (m_comparator(lo, m_keySelector(*Eco_AVL_ELEM(hook))) <= 0)
+			{
+				lAggregate = TAugment::Combine(TAugment::Combine(ElementValue(hook),
+					SubtreeAggregate(hook->children[1].Ptr())), lAggregate);
+				hook = hook->children[0].Ptr();
+			}
+			else
+			{
+				hook = hook->children[1].Ptr();
+			}
+		}
+
+		// Along the search for hi, each hook ordered before hi is preceded by its left subtree.
+		ValueType rAggregate = TAugment::Identity();
+		for (Hook* hook = split->children[1].Ptr(); hook != nullptr;)
+		{
+			if (m_comparator(hi, m_keySelector(*Eco_AVL_ELEM(hook))) > 0)
+			{
+				rAggregate = TAugment::Combine(rAggregate, TAugment::Combine(
+					SubtreeAggregate(hook->children[0].Ptr()), ElementValue(hook)));
+				hook = hook->children[1].Ptr();
+			}
+			else
+			{
+				hook = hook->children[0].Ptr();
+			}
+		}
+
+		return static_cast<ValueType>(TAugment::Combine(
+			TAugment::Combine(lAggregate, ElementValue(split)), rAggregate));
+	}
+
+	/// @brief Select an element at random with probability proportional to its weight in O(log n) time.
+	/// The augmentation provides the weight of each element as its value, and maintains the sum
+	/// of the weights of each subtree as its aggregate.
+	/// @param random Uniform random bit generator.
+	/// @return Pointer to the sampled element, or null if the total weight is zero.
+	/// @pre The weights are not negative.
+	/// @pre The aggregate type can represent the total weight, as the subtree sums are
+	/// computed by the augmentation and a truncated sum would bias the selection.
+	template<std::uniform_random_bit_generator TRandom>
+	[[nodiscard]] T* SampleWeighted(TRandom& random)
+		requires std::is_arithmetic_v<typename TAugment::ValueType>
+	{
+		return Eco_AVL_ELEM(SampleWeightedInternal(random));
+	}
+
+	/// @brief Select an element at random with probability proportional to its weight in O(log n) time.
+	/// @param random Uniform random bit generator.
+	/// @return Pointer to the sampled element, or null if the total weight is zero.
+	/// @pre The weights are not negative.
+	/// @pre The aggregate type can represent the total weight, as the subtree sums are
+	/// computed by the augmentation and a truncated sum would bias the selection.
+	template<std::uniform_random_bit_generator TRandom>
+	[[nodiscard]] const T* SampleWeighted(TRandom& random) const
+		requires std::is_arithmetic_v<typename TAugment::ValueType>
+	{
+		return Eco_AVL_ELEM(SampleWeightedInternal(random));
+	}
+
+
+	/// @brief Find elements by multiple homogeneous keys.
+	/// The searches are advanced in an interleaved manner, prefetching the next hook of
+	/// each search, so that the cache misses of independent searches overlap.
+	/// @param keys Lookup keys.
+	/// @param elements Receives a pointer to the element for each key, or null if not found.
+	/// @pre @p elements is at least as large as @p keys.
+	void FindBatch(std::span<const std::remove_cvref_t<KeyType>> const keys, std::span<T*> const elements)
+	{
+		FindBatchInternal(keys, elements);
+	}
+
+	/// @brief Find elements by multiple homogeneous keys.
+	/// The searches are advanced in an interleaved manner, prefetching the next hook of
+	/// each search, so that the cache misses of independent searches overlap.
+	/// @param keys Lookup keys.
+	/// @param elements Receives a pointer to the element for each key, or null if not found.
+	/// @pre @p elements is at least as large as @p keys.
+	void FindBatch(std::span<const std::remove_cvref_t<KeyType>> const keys, std::span<const T*> const elements) const
+	{
+		FindBatchInternal(keys, elements);
+	}
+
+	/// @brief Find the first element whose key is not ordered before a key.
+	/// @param key Lookup key.
+	/// @return Iterator referring to the element, or the end iterator.
+	[[nodiscard]] iterator LowerBound(const KeyType& key)
+	{
+		return iterator(BoundInternal(key, false));
+	}
+
+	/// @brief Find the first element whose key is not ordered before a key.
+	/// @param key Lookup key.
+	/// @return Iterator referring to the element, or the end iterator.
+	[[nodiscard]] const_iterator LowerBound(const KeyType& key) const
+	{
+		return const_iterator(BoundInternal(key, false));
+	}
+
+	/// @brief Find the first element whose key is not ordered before a heterogeneous key.
+	/// @param key Lookup key.
+	/// @return Iterator referring to the element, or the end iterator.
+	template<typename TKey>
+	[[nodiscard]] iterator LowerBoundEquivalent(const TKey& key)
+		requires (requires (const KeyType& containerKey) { m_comparator(key, containerKey); })
+	{
+		return iterator(BoundInternal(key, false));
+	}
+
+	/// @brief Find the first element whose key is not ordered before a heterogeneous key.
+	/// @param key Lookup key.
+	/// @return Iterator referring to the element, or the end iterator.
+	template<typename TKey>
+	[[nodiscard]] const_iterator LowerBoundEquivalent(const TKey& key) const
+		requires (requires (const KeyType& containerKey) { m_comparator(key, containerKey); })
+	{
+		return const_iterator(BoundInternal(key, false));
+	}
+
+	/// @brief Find the first element whose key is ordered after a key.
+	/// @param key Lookup key.
+	/// @return Iterator referring to the element, or the end iterator.
+	[[nodiscard]] iterator UpperBound(const KeyType& key)
+	{
+		return iterator(BoundInternal(key, true));
+	}
+
+	/// @brief Find the first element whose key is ordered after a key.
+	/// @param key Lookup key.
+	/// @return Iterator referring to the element, or the end iterator.
+	[[nodiscard]] const_iterator UpperBound(const KeyType& key) const
+	{
+		return const_iterator(BoundInternal(key, true));
+	}
+
+	/// @brief Find the first element whose key is ordered after a heterogeneous key.
+	/// @param key Lookup key.
+	/// @return Iterator referring to the element, or the end iterator.
+	template<typename TKey>
+	[[nodiscard]] iterator UpperBoundEquivalent(const TKey& key)
+		requires (requires (const KeyType& containerKey) { m_comparator(key, containerKey); })
+	{
+		return iterator(BoundInternal(key, true));
+	}
+
+	/// @brief Find the first element whose key is ordered after a heterogeneous key.
+	/// @param key Lookup key.
+	/// @return Iterator referring to the element, or the end iterator.
+	template<typename TKey>
+	[[nodiscard]] const_iterator UpperBoundEquivalent(const TKey& key) const
+		requires (requires (const KeyType& containerKey) { m_comparator(key, containerKey); })
+	{
+		return const_iterator(BoundInternal(key, true));
+	}
+
+	/// @brief Find the range of elements with keys equivalent to a key.
+	/// @param key Lookup key.
+	/// @return Range containing the matching element, or an empty range at its lower bound.
+	[[nodiscard]] std::ranges::subrange<iterator> EqualRange(const KeyType& key)
+	{
+		return { iterator(BoundInternal(key, false)), iterator(BoundInternal(key, true)) };
+	}
+
+	/// @brief Find the range of elements with keys equivalent to a key.
+	/// @param key Lookup key.
+	/// @return Range containing the matching element, or an empty range at its lower bound.
+	[[nodiscard]] std::ranges::subrange<const_iterator> EqualRange(const KeyType& key) const
+	{
+		return { const_iterator(BoundInternal(key, false)), const_iterator(BoundInternal(key, true)) };
+	}
+
+	/// @brief Find the range of elements with keys equivalent to a heterogeneous key.
+	/// @param key Lookup key.
+	/// @return Range of the matching elements, or an empty range at their lower bound.
+	template<typename TKey>
+	[[nodiscard]] std::ranges::subrange<iterator> EqualRangeEquivalent(const TKey& key)
+		requires (requires (const KeyType& containerKey) { m_comparator(key, containerKey); })
+	{
+		return { iterator(BoundInternal(key, false)), iterator(BoundInternal(key, true)) };
+	}
+
+	/// @brief Find the range of elements with keys equivalent to a heterogeneous key.
+	/// @param key Lookup key.
+	/// @return Range of the matching elements, or an empty range at their lower bound.
+	template<typename TKey>
+	[[nodiscard]] std::ranges::subrange<const_iterator> EqualRangeEquivalent(const TKey& key) const
+		requires (requires (const KeyType& containerKey) { m_comparator(key, containerKey); })
+	{
+		return { const_iterator(BoundInternal(key, false)), const_iterator(BoundInternal(key, true)) };
+	}
+
+	/// @brief Create a view of the elements with keys in the half-open interval [lo, hi).
+	/// @param lo Inclusive lower bound.
+	/// @param hi Exclusive upper bound.
+	/// @pre @p lo is not ordered after @p hi.
+	[[nodiscard]] std::ranges::subrange<iterator> Range(const KeyType& lo, const KeyType& hi)
+	{
+		return { iterator(BoundInternal(lo, false)), iterator(BoundInternal(hi, false)) };
+	}
+
+	/// @brief Create a view of the elements with keys in the half-open interval [lo, hi).
+	/// @param lo Inclusive lower bound.
+	/// @param hi Exclusive upper bound.
+	/// @pre @p lo is not ordered after @p hi.
+	[[nodiscard]] std::ranges::subrange<const_iterator> Range(const KeyType& lo, const KeyType& hi) const
+	{
+		return { const_iterator(BoundInternal(lo, false)), const_iterator(BoundInternal(hi, false)) };
+	}
+
+	/// @brief Create a view of the elements with keys in the half-open interval [lo, hi) of heterogeneous keys.
+	/// @param lo Inclusive lower bound.
+	/// @param hi Exclusive upper bound.
+	/// @pre @p lo is not ordered after @p hi.
+	template<typename TKey>
+	[[nodiscard]] std::ranges::subrange<iterator> RangeEquivalent(const TKey& lo, const TKey& hi)
+		requires (requires (const KeyType& containerKey) { m_comparator(lo, containerKey); })
+	{
+		return { iterator(BoundInternal(lo, false)), iterator(BoundInternal(hi, false)) };
+	}
+
+	/// @brief Create a view of the elements with keys in the half-open interval [lo, hi) of heterogeneous keys.
+	/// @param lo Inclusive lower bound.
+	/// @param hi Exclusive upper bound.
+	/// @pre @p lo is not ordered after @p hi.
+	template<typename TKey>
+	[[nodiscard]] std::ranges::subrange<const_iterator> RangeEquivalent(const TKey& lo, const TKey& hi) const
+		requires (requires (const KeyType& containerKey) { m_comparator(lo, containerKey); })
+	{
+		return { const_iterator(BoundInternal(lo, false)), const_iterator(BoundInternal(hi, false)) };
+	}
+
 
 	/// @brief Insert new element into the tree.
 	/// @param element Element to be inserted.
@@ -289,21 +753,366 @@ public:
 	{
 		auto const r = FindInternal(m_keySelector(*element));
 		if (r.hook != nullptr) return { Eco_AVL_ELEM(r.hook), false };
-		Core::Insert(Eco_AVL_HOOK(element), ConstCast<Ptr<Ptr<Hook>>>(r.parent));
+		StoreKeyPrefix(element);
+		Core::Insert(Eco_AVL_HOOK(element), ConstCast<Ptr<Ptr<Hook>>>(r.parent), GetAugment());
 		return { element, true };
 	}
 
+	/// @brief Insert new element into the tree at a suggested position.
+	/// @param hint Iterator referring to the element before which @p element would be inserted.
+	/// @param element Element to be inserted.
+	/// @pre @p element is not part of any container.
+	/// @note If the hint is correct, only the neighbouring keys are compared and the
+	///       insertion takes amortized constant time. Otherwise this falls back to Insert.
+	InsertResult InsertHint(iterator const hint, T* const element)
+	{
+		auto const r = Core::FindHint(hint != end() ? Eco_AVL_HOOK(&*hint) : nullptr);
+		auto&& key = m_keySelector(*element);
+
+		if (r.prev != nullptr)
+		{
+			auto const ordering = m_comparator(key, m_keySelector(*Eco_AVL_ELEM(r.prev)));
+			if (ordering == 0) return { Eco_AVL_ELEM(r.prev), false };
+			if (ordering < 0) return Insert(element);
+		}
+
+		if (hint != end())
+		{
+			auto const ordering = m_comparator(key, m_keySelector(*hint));
+			if (ordering == 0) return { &*hint, false };
+			if (ordering > 0) return Insert(element);
+		}
+
+		StoreKeyPrefix(element);
+		Core::Insert(Eco_AVL_HOOK(element), r.parent, GetAugment());
+		return { element, true };
+	}
+
+	/// @brief Insert new element which is expected to be ordered after all elements.
+	/// @param element Element to be inserted.
+	/// @pre @p element is not part of any container.
+	/// @note If the element is ordered after all elements, only the last key is compared.
+	///       Otherwise this falls back to Insert.
+	InsertResult AppendMax(T* const element)
+	{
+		return InsertHint(end(), element);
+	}
+
+	/// @brief Find element by homogeneous key, or the position at which it would be inserted.
+	/// @param key Lookup key.
+	/// @return Matching element, or null and the insert position for use with @ref InsertAt.
+	/// @note This allows constructing a new element only if the key is not found.
+	[[nodiscard]] PrepareResult FindOrPrepare(const KeyType& key)
+	{
+		return FindOrPrepareInternal(key);
+	}
+
+	/// @brief Find element by heterogeneous key, or the position at which it would be inserted.
+	/// @param key Lookup key.
+	/// @return Matching element, or null and the insert position for use with @ref InsertAt.
+	/// @note This allows constructing a new element only if the key is not found.
+	template<typename TKey>
+	[[nodiscard]] PrepareResult FindOrPrepareEquivalent(const TKey& key)
+		requires (requires (const KeyType& containerKey) { m_comparator(key, containerKey); })
+	{
+		return FindOrPrepareInternal(key);
+	}
+
+	/// @brief Insert new element at a position returned by @ref FindOrPrepare without searching.
+	/// @param position Insert position returned for a key not found in the set.
+	/// @param element Element to be inserted.
+	/// @pre @p element is not part of any container.
+	/// @pre The key of @p element is equivalent to the key passed to @ref FindOrPrepare.
+	/// @pre The set has not been modified since the call to @ref FindOrPrepare.
+	void InsertAt(InsertPosition const position, T* const element)
+	{
+		Eco_Assert(position.m_parent.Ptr()[position.m_parent.Tag()].IsZero());
+		StoreKeyPrefix(element);
+		Core::Insert(Eco_AVL_HOOK(element), position.m_parent, GetAugment());
+	}
+
 	/// @brief Remove an element from the tree.
 	/// @param element Element to be removed.
 	/// @pre @p element is part of this tree.
 	void Remove(T* const element)
 	{
-		Core::Remove(Eco_AVL_HOOK(element));
+		Core::Remove(Eco_AVL_HOOK(element), GetAugment());
+	}
+
+	/// @brief Replace an element by a copy at a new address, such as after moving it in memory.
+	/// The links referring to the element are redirected to the copy in constant time.
+	/// @param element Element to be replaced.
+	/// @param newElement Bitwise copy of @p element, which takes its place in the tree.
+	/// @pre @p element is part of this tree.
+	/// @note Iterators referring to @p element are invalidated.
+	void Relocate(T* const element, T* const newElement)
+	{
+		Core::Relocate(Eco_AVL_HOOK(element), Eco_AVL_HOOK(newElement));
 	}
 
 	/// @brief Remove all elements from the tree.
 	using Core::Clear;
 
+	/// @brief Split the set at a key in logarithmic time.
+	/// @param key Split key.
+	/// @return Set containing the elements not ordered before @p key.
+	///         Those elements are removed from this set.
+	/// @note The sizes of the two sets are not known after splitting. Each is counted in linear
+	///       time by the first call to @ref Size, while other operations remain unaffected.
+	[[nodiscard]] AvlSet Split(const KeyType& key)
+	{
+		AvlSet set(m_keySelector, m_comparator);
+		auto const r = FindInternal(key);
+		Core::Split(r.hook, ConstCast<Ptr<Ptr<Hook>>>(r.parent), set, GetAugment());
+		return set;
+	}
+
+	/// @brief Move all elements of another set into this set in logarithmic time.
+	/// @param other Set whose elements are moved into this set.
+	/// @pre The keys of @p other are either all ordered before or all ordered after the keys of this set.
+	void Join(AvlSet& other)
+	{
+		bool const after = IsEmpty() || other.IsEmpty() ||
+			m_comparator(m_keySelector(*std::prev(end())), m_keySelector(*other.begin())) < 0;
+
+		Eco_Assert(after || m_comparator(m_keySelector(*std::prev(other.end())), m_keySelector(*begin())) < 0);
+
+		Core::Join(other, after, GetAugment());
+	}
+
+	/// @brief Move the elements of another set into this set, except those whose keys are already present.
+	/// @param other Set whose elements are moved into this set.
+	///        Left containing the elements whose keys were already present in this set.
+	void Union(AvlSet& other)
+	{
+		Core::Union(other, Comparator, GetAugment(), nullptr);
+	}
+
+	/// @brief Move the elements of another set into this set, except those whose keys are already present.
+	/// @param other Set whose elements are moved into this set.
+	///        Left containing the elements whose keys were already present in this set.
+	/// @param executor Executor used to process independent parts of the sets in parallel.
+	template<Executor TExecutor>
+	void Union(AvlSet& other, TExecutor&& executor)
+	{
+		ExecutorRef const executorRef(executor);
+		Core::Union(other, Comparator, GetAugment(), &executorRef);
+	}
+
+	/// @brief Remove the elements whose keys are not present in another set.
+	/// @param other Set whose keys are retained.
+	/// @return Set containing the removed elements.
+	AvlSet Intersect(const AvlSet& other)
+	{
+		return Filter(other, true, nullptr);
+	}
+
+	/// @brief Remove the elements whose keys are not present in another set.
+	/// @param other Set whose keys are retained.
+	/// @param executor Executor used to process independent parts of the sets in parallel.
+	/// @return Set containing the removed elements.
+	template<Executor TExecutor>
+	AvlSet Intersect(const AvlSet& other, TExecutor&& executor)
+	{
+		ExecutorRef const executorRef(executor);
+		return Filter(other, true, &executorRef);
+	}
+
+	/// @brief Remove the elements whose keys are present in another set.
+	/// @param other Set whose keys are removed.
+	/// @return Set containing the removed elements.
+	AvlSet Difference(const AvlSet& other)
+	{
+		return Filter(other, false, nullptr);
+	}
+
+	/// @brief Remove the elements whose keys are present in another set.
+	/// @param other Set whose keys are removed.
+	/// @param executor Executor used to process independent parts of the sets in parallel.
+	/// @return Set containing the removed elements.
+	template<Executor TExecutor>
+	AvlSet Difference(const AvlSet& other, TExecutor&& executor)
+	{
+		ExecutorRef const executorRef(executor);
+		return Filter(other, false, &executorRef);
+	}
+
+	/// @brief Build a perfectly balanced tree from a sorted list in linear time.
+	/// @param list Elements in strictly ascending key order. The list is left empty.
+	/// @pre The set is empty.
+	void Build(List<T>& list)
+	{
+		if constexpr (HasKeyPrefix)
+		{
+			for (T& element : list)
+				StoreKeyPrefix(&element);
+		}
+
+		size_t const size = list.Size();
+		Core::Build(list.Release(*this), size, GetAugment());
+		Eco_AssertSlow(IsOrdered());
+	}
+
+	/// @brief Build a perfectly balanced tree from a sorted range of elements in linear time.
+	/// @param elements Elements in strictly ascending key order.
+	/// @pre The set is empty.
+	/// @pre The elements are not part of any container.
+	template<std::ranges::input_range TRange>
+	void Build(TRange&& elements)
+		requires std::convertible_to<std::ranges::range_reference_t<TRange>, T*>
+	{
+		List_::Hook* list = nullptr;
+		List_::Hook** next = &list;
+		size_t size = 0;
+
+		for (T* const element : elements)
+		{
+			Hook* const hook = Eco_AVL_HOOK(element);
+			LinkInsert(*hook, *this);
+			StoreKeyPrefix(element);
+
+			*next = reinterpret_cast<List_::Hook*>(hook);
+			next = &(*next)->siblings[0];
+			++size;
+		}
+
+		Core::Build(list, size, GetAugment());
+		Eco_AssertSlow(IsOrdered());
+	}
+
+	/// @brief Merge a sorted batch of elements into the set in O(m log(n/m + 1)) time.
+	/// The batch is built into a tree in linear time and then merged using @ref Union,
+	/// which shares the work of descending into the set between neighbouring elements.
+	/// @param list Elements in ascending key order. Left containing the elements whose keys
+	///        were already present in the set or repeated within the batch, in ascending key order.
+	/// @pre The elements of @p list are in ascending key order.
+	void InsertSorted(List<T>& list)
+	{
+		// Move the elements repeating a key aside, so that the rest can be built into a tree.
+		List<T> repeated;
+		for (auto it = list.begin(); it != list.end();)
+		{
+			T* const element = &*it++;
+			if (it != list.end())
+			{
+				auto const ordering = m_comparator(m_keySelector(*element), m_keySelector(*it));
+				Eco_Assert(ordering <= 0);
+
+				if (ordering == 0)
+				{
+					list.Remove(element);
+					repeated.Append(element);
+				}
+			}
+		}
+
+		AvlSet batch(m_keySelector, m_comparator);
+		batch.Build(list);
+		Union(batch);
+
+		// Merge the two kinds of rejected elements back into the list in key order.
+		List<T> present = batch.Flatten();
+		while (!present.IsEmpty() || !repeated.IsEmpty())
+		{
+			bool const first = repeated.IsEmpty() || (!present.IsEmpty() &&
+				m_comparator(m_keySelector(*present.First()), m_keySelector(*repeated.First())) <= 0);
+
+			List<T>& source = first ? present : repeated;
+			T* const element = source.First();
+
+			source.Remove(element);
+			list.Append(element);
+		}
+	}
+
+	/// @brief Invoke a function for each element in order.
+	/// @param function Function invoked with a reference to each element.
+	/// @note The tree is traversed recursively while prefetching the children of each element,
+	///       which is faster than iterating using iterators.
+	/// @note The function must not modify the set.
+	template<typename TFunction>
+	void ForEach(TFunction&& function)
+		requires std::invocable<TFunction&, T&>
+	{
+		ForEachInternal<T>(m_root->Ptr(), function);
+	}
+
+	/// @brief Invoke a function for each element in order.
+	/// @param function Function invoked with a reference to each element.
+	template<typename TFunction>
+	void ForEach(TFunction&& function) const
+		requires std::invocable<TFunction&, const T&>
+	{
+		ForEachInternal<const T>(m_root->Ptr(), function);
+	}
+
+	/// @brief Invoke a function for each element in parallel.
+	/// The tree is divided into disjoint subtrees, each of which is visited in order by a single task.
+	/// @param executor Executor used to visit the subtrees in parallel.
+	/// @param function Function invoked with a reference to each element.
+	/// @note The function is invoked concurrently for elements in different subtrees.
+	/// @note The function must not modify the set.
+	template<Executor TExecutor, typename TFunction>
+	void ParallelForEach(TExecutor&& executor, TFunction&& function)
+		requires std::invocable<TFunction&, T&>
+	{
+		ParallelForEachInternal<T>(ExecutorRef(executor), function);
+	}
+
+	/// @brief Invoke a function for each element in parallel.
+	/// @param executor Executor used to visit the subtrees in parallel.
+	/// @param function Function invoked with a reference to each element.
+	template<Executor TExecutor, typename TFunction>
+	void ParallelForEach(TExecutor&& executor, TFunction&& function) const
+		requires std::invocable<TFunction&, const T&>
+	{
+		ParallelForEachInternal<const T>(ExecutorRef(executor), function);
+	}
+
+	/// @brief Move all elements into contiguous storage in an order which improves locality.
+	/// @param buffer Uninitialized storage for @ref Size elements.
+	/// @param move Function invoked as @c move(element, destination) for each element,
+	///        which must construct a copy of the element and its link at the destination,
+	///        for example by move construction.
+	/// @param layout Order of the elements in the storage.
+	/// @note The old elements are no longer part of the set afterwards and may then be destroyed.
+	///       They must not be destroyed by @p move.
+	/// @note Iterators are invalidated.
+	template<typename TMove>
+	void CompactLayout(T* const buffer, TMove&& move, AvlSetLayout const layout = AvlSetLayout::InOrder)
+		requires std::invocable<TMove&, T&, T*>
+	{
+		T* destination = buffer;
+		auto const relocate = [&](T& element)
+		{
+			T* const newElement = destination++;
+			move(element, newElement);
+			Core::Relocate(Eco_AVL_HOOK(&element), Eco_AVL_HOOK(newElement));
+		};
+
+		switch (layout)
+		{
+		case AvlSetLayout::InOrder:
+			// The traversal loads the children of each element before visiting it.
+			ForEachInternal<T>(m_root->Ptr(), relocate);
+			break;
+
+		case AvlSetLayout::BreadthFirst:
+			if (!m_root->IsZero())
+				relocate(*Eco_AVL_ELEM(m_root->Ptr()));
+
+			// The relocated elements double as the queue of the traversal.
+			for (T* element = buffer; element != destination; ++element)
+			{
+				for (Ptr<Hook> const child : Eco_AVL_HOOK(element)->children)
+					if (!child.IsZero()) relocate(*Eco_AVL_ELEM(child.Ptr()));
+			}
+			break;
+		}
+
+		Eco_Assert(destination == buffer + Size());
+	}
+
 	/// @brief Flatten the tree into a linked list using an in-order traversal.
 	[[nodiscard]] List<T> Flatten()
 	{
@@ -311,6 +1120,30 @@ public:
 		return List<T>(static_cast<LinkContainer&&>(*this), Core::Flatten(), size);
 	}
 
+	/// @brief Remove the elements with keys in the half-open interval [lo, hi).
+	/// @param lo Inclusive lower bound.
+	/// @param hi Exclusive upper bound.
+	/// @return List of the removed elements in order.
+	/// @pre @p lo is not ordered after @p hi.
+	/// @note The range is detached by splitting and joining the tree in logarithmic time,
+	///       after which the removed elements are linked into the list in linear time.
+	[[nodiscard]] List<T> RemoveRange(const KeyType& lo, const KeyType& hi)
+	{
+		return RemoveRangeInternal(lo, hi);
+	}
+
+	/// @brief Remove the elements with keys in the half-open interval [lo, hi) of heterogeneous keys.
+	/// @param lo Inclusive lower bound.
+	/// @param hi Exclusive upper bound.
+	/// @return List of the removed elements in order.
+	/// @pre @p lo is not ordered after @p hi.
+	template<typename TKey>
+	[[nodiscard]] List<T> RemoveRangeEquivalent(const TKey& lo, const TKey& hi)
+		requires (requires (const KeyType& containerKey) { m_comparator(lo, containerKey); })
+	{
+		return RemoveRangeInternal(lo, hi);
+	}
+
 
 	/// @brief Create an iterator referring to an element.
 	/// @pram element Element to which the resulting iterator shall refer.
@@ -405,17 +1238,323 @@ public:
 #endif
 
 private:
+	bool IsOrdered() const
+	{
+		auto it = begin();
+		auto const end = this->end();
+
+		if (it != end)
+		{
+			for (auto prev = it; ++it != end; prev = it)
+			{
+				if (m_comparator(m_keySelector(*prev), m_keySelector(*it)) >= 0)
+					return false;
+			}
+		}
+
+		return true;
+	}
+
+	static constexpr Augment* GetAugment()
+	{
+		if constexpr (std::is_same_v<TAugment, NoAugment>)
+		{
+			return nullptr;
+		}
+		else
+		{
+			return AugmentHook;
+		}
+	}
+
+	static void AugmentHook(Hook* const hook)
+	{
+		typename TAugment::ValueType aggregate = ElementValue(hook);
+
+		if (Hook* const child = hook->children[0].Ptr())
+			aggregate = TAugment::Combine(TAugment::Aggregate(*Eco_AVL_ELEM(child)), aggregate);
+
+		if (Hook* const child = hook->children[1].Ptr())
+			aggregate = TAugment::Combine(aggregate, TAugment::Aggregate(*Eco_AVL_ELEM(child)));
+
+		TAugment::Aggregate(*Eco_AVL_ELEM(hook)) = static_cast<typename TAugment::ValueType&&>(aggregate);
+	}
+
+	// The return types are deduced to keep the declarations valid without augmentation.
+	static auto ElementValue(Hook* const hook)
+	{
+		using ValueType = typename TAugment::ValueType;
+		return static_cast<ValueType>(TAugment::Value(const_cast<const T&>(*Eco_AVL_ELEM(hook))));
+	}
+
+	static auto SubtreeAggregate(Hook* const hook)
+	{
+		using ValueType = typename TAugment::ValueType;
+		return hook != nullptr
+			? static_cast<ValueType>(TAugment::Aggregate(*Eco_AVL_ELEM(hook)))
+			: static_cast<ValueType>(TAugment::Identity());
+	}
+
+	template<typename TRandom>
+	Hook* SampleWeightedInternal(TRandom& random) const
+	{
+		using ValueType = typename TAugment::ValueType;
+
+		// Integer points are drawn in the widest integer type of the same signedness, as the
+		// standard distributions are not defined for character and small integer types.
+		// The subtree sums are still those computed by the augmentation in its aggregate type.
+		using PointType = std::conditional_t<std::is_floating_point_v<ValueType>, ValueType,
+			std::conditional_t<std::is_signed_v<ValueType>, intmax_t, uintmax_t>>;
+
+		PointType const total = static_cast<PointType>(SubtreeAggregate(m_root->Ptr()));
+		if (!(total > 0)) return nullptr;
+
+		// Find the element whose weight covers a point drawn from [0, total).
+		PointType point;
+		if constexpr (std::is_integral_v<PointType>)
+			point = std::uniform_int_distribution<PointType>(0, total - 1)(random);
+		else
+			point = std::uniform_real_distribution<PointType>(0, total)(random);
+
+		Hook* hook = m_root->Ptr();
+		while (true)
+		{
+			Hook* const l = hook->children[0].Ptr();
+			PointType const lWeight = static_cast<PointType>(SubtreeAggregate(l));
+
+			// A sum exceeding the aggregate type is truncated and no longer covers its subtree.
+			if constexpr (std::is_integral_v<ValueType>)
+			{
+				Eco_Assert(static_cast<PointType>(SubtreeAggregate(hook)) == lWeight +
+					static_cast<PointType>(ElementValue(hook)) +
+					static_cast<PointType>(SubtreeAggregate(hook->children[1].Ptr())));
+			}
+
+			if (point < lWeight)
+			{
+				hook = l;
+				continue;
+			}
+			point -= lWeight;
+
+			// Rounding of floating point weights may leave the point past the last element.
+			Hook* const r = hook->children[1].Ptr();
+			PointType const weight = static_cast<PointType>(ElementValue(hook));
+			if (point < weight || r == nullptr) return hook;
+			point -= weight;
+
+			hook = r;
+		}
+	}
+
+	AvlSet Filter(const AvlSet& other, bool const contained, const ExecutorRef* const executor)
+	{
+		AvlSet removed(m_keySelector, m_comparator);
+		Core::Filter(other, contained, removed, Comparator, GetAugment(), executor);
+		return removed;
+	}
+
+	static int Comparator(const Core* const core, Hook* const lhs, Hook* const rhs)
+	{
+		const AvlSet* const self = static_cast<const AvlSet*>(core);
+
+		if constexpr (HasKeyPrefix)
+		{
+			uint64_t const lPrefix = LoadKeyPrefix(lhs);
+			uint64_t const rPrefix = LoadKeyPrefix(rhs);
+			if (lPrefix != rPrefix) return lPrefix < rPrefix ? -1 : 1;
+		}
+
+		auto const ordering = self->m_comparator(
+			self->m_keySelector(const_cast<const T&>(*Eco_AVL_ELEM(lhs))),
+			self->m_keySelector(const_cast<const T&>(*Eco_AVL_ELEM(rhs))));
+		return (ordering > 0) - (ordering < 0);
+	}
+
+	static uint64_t LoadKeyPrefix(Hook* const hook)
+	{
+		return static_cast<KeyPrefixHook*>(hook)->prefix.Load();
+	}
+
+	void StoreKeyPrefix([[maybe_unused]] T* const element) const
+	{
+		if constexpr (HasKeyPrefix)
+		{
+			static_cast<KeyPrefixHook*>(Eco_AVL_HOOK(element))->prefix.Store(
+				TKeyPrefix::Prefix(m_keySelector(const_cast<const T&>(*element))));
+		}
+	}
+
+	template<typename TKey>
+	static uint64_t KeyPrefix(const TKey& key)
+	{
+		if constexpr (UsesKeyPrefix<TKey>)
+		{
+			return TKeyPrefix::Prefix(key);
+		}
+		else
+		{
+			return 0;
+		}
+	}
+
+	// Compare a key with the key of a hook, first comparing the cached prefixes if possible.
+	template<typename TKey>
+	auto CompareKey(const TKey& key, [[maybe_unused]] uint64_t const prefix, Hook* const hook) const
+	{
+		if constexpr (UsesKeyPrefix<TKey>)
+		{
+			uint64_t const hookPrefix = LoadKeyPrefix(hook);
+			if (prefix != hookPrefix) return prefix < hookPrefix ? -1 : 1;
+
+			auto const ordering = m_comparator(key, m_keySelector(*Eco_AVL_ELEM(hook)));
+			return (ordering > 0) - (ordering < 0);
+		}
+		else
+		{
+			return m_comparator(key, m_keySelector(*Eco_AVL_ELEM(hook)));
+		}
+	}
+
+	template<typename TElement, typename TFunction>
+	static void ForEachInternal(Hook* hook, TFunction& function)
+	{
+		while (hook != nullptr)
+		{
+			Hook* const l = hook->children[0].Ptr();
+			Hook* const r = hook->children[1].Ptr();
+			Eco_PREFETCH(l);
+			Eco_PREFETCH(r);
+
+			ForEachInternal<TElement>(l, function);
+			function(static_cast<TElement&>(*Eco_AVL_ELEM(hook)));
+
+			hook = r;
+		}
+	}
+
+	template<typename TElement, typename TFunction>
+	void ParallelForEachInternal(ExecutorRef const& executor, TFunction& function) const
+	{
+		struct Context
+		{
+			Division division;
+			TFunction* function;
+		};
+
+		Context context;
+		context.function = &function;
+		Core::Divide(context.division, executor);
+
+		// Each subtree is followed by the pivot ordered after it.
+		executor.Run(context.division.count, [](void* const c, size_t const index)
+		{
+			Context& context = *static_cast<Context*>(c);
+			ForEachInternal<TElement>(context.division.subtrees[index], *context.function);
+
+			if (index + 1 < context.division.count)
+				(*context.function)(static_cast<TElement&>(*Eco_AVL_ELEM(context.division.pivots[index])));
+		}, &context);
+	}
+
+	// Find the first hook whose key is ordered after the key, or equivalent to it unless upper.
+	// Returns the children of the hook, or the root pointer if there is none.
+	template<typename TKey>
+	RootType* BoundInternal(const TKey& key, bool const upper) const
+	{
+		RootType* bound = const_cast<RootType*>(&m_root.Value);
+		Hook* hook = m_root->Ptr();
+
+		uint64_t const prefix = KeyPrefix(key);
+		while (hook != nullptr)
+		{
+			auto const ordering = CompareKey(key, prefix, hook);
+			if (ordering == 0 && !upper) return hook->children;
+
+			bool const r = ordering >= 0;
+			if (!r) bound = hook->children;
+			hook = hook->children[r].Ptr();
+		}
+
+		return bound;
+	}
+
+	template<typename TElement>
+	void FindBatchInternal(std::span<const std::remove_cvref_t<KeyType>> const keys, std::span<TElement*> const elements) const
+	{
+		Eco_Assert(elements.size() >= keys.size());
+
+		// Number of searches in flight at a time.
+		static constexpr size_t GroupSize = 16;
+
+		Hook* const root = m_root->Ptr();
+
+		Hook* hooks[GroupSize];
+		size_t indices[GroupSize];
+		uint64_t prefixes[GroupSize];
+
+		size_t next = 0;
+		size_t active = 0;
+
+		while (active < GroupSize && next < keys.size())
+		{
+			hooks[active] = root;
+			prefixes[active] = KeyPrefix(keys[next]);
+			indices[active++] = next++;
+		}
+
+		while (active != 0)
+		{
+			for (size_t i = 0; i < active;)
+			{
+				Hook* const hook = hooks[i];
+				size_t const index = indices[i];
+
+				if (hook != nullptr)
+				{
+					auto const ordering = CompareKey(keys[index], prefixes[i], hook);
+					if (ordering != 0)
+					{
+						Hook* const child = hook->children[ordering > 0].Ptr();
+						Eco_PREFETCH(child);
+
+						hooks[i++] = child;
+						continue;
+					}
+				}
+
+				elements[index] = Eco_AVL_ELEM(hook);
+
+				// Start the next search in place of the finished one.
+				if (next < keys.size())
+				{
+					hooks[i] = root;
+					prefixes[i] = KeyPrefix(keys[next]);
+					indices[i++] = next++;
+				}
+				else
+				{
+					--active;
+					hooks[i] = hooks[active];
+					prefixes[i] = prefixes[active];
+					indices[i] = indices[active];
+				}
+			}
+		}
+	}
+
 	template<typename TKey>
 	FindResult FindInternal(const TKey& key) const
 	{
 		const Ptr<Hook>* parent = &m_root.Value;
 		uintptr_t l = 0;
 
+		uint64_t const prefix = KeyPrefix(key);
 		while (!parent[l].IsZero())
 		{
 			Hook* const child = parent[l].Ptr();
 
-			auto const ordering = m_comparator(key, m_keySelector(*Eco_AVL_ELEM(child)));
+			auto const ordering = CompareKey(key, prefix, child);
 			if (ordering == 0) return { child, { parent, l } };
 
 			parent = child->children;
@@ -424,6 +1563,24 @@ private:
 
 		return FindResult{ nullptr, { parent, l } };
 	}
+
+	template<typename TKey>
+	List<T> RemoveRangeInternal(const TKey& lo, const TKey& hi)
+	{
+		Core removed;
+		List_::Hook* const list = Core::RemoveRange(BoundInternal(lo, false), BoundInternal(hi, false), removed, GetAugment());
+
+		size_t const size = removed.m_size.Value;
+		return List<T>(static_cast<LinkContainer&&>(removed), list, size);
+	}
+
+	template<typename TKey>
+	PrepareResult FindOrPrepareInternal(const TKey& key)
+	{
+		auto const r = FindInternal(key);
+		if (r.hook != nullptr) return { Eco_AVL_ELEM(r.hook), {} };
+		return { nullptr, InsertPosition(ConstCast<Ptr<Ptr<Hook>>>(r.parent)) };
+	}
 };
 
 #undef Eco_AVL_HOOK
@@ -432,6 +1589,9 @@ private:
 } // namespace Private::AvlSet_
 
 using Private::AvlSet_::AvlSet;
+using Private::AvlSet_::AvlSetAugment;
+using Private::AvlSet_::AvlSetLayout;
+using Private::AvlSet_::NoAugment;
 
 // } // inline namespace Eco_NS
 } // namespace Eco
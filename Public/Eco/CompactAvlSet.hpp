@@ -0,0 +1,387 @@
+#pragma once
+
+#include "Eco/Attributes.hpp"
+#include "Eco/InsertResult.hpp"
+#include "Eco/KeySelector.hpp"
+#include "Eco/Linear.hpp"
+#include "Eco/Link.hpp"
+#include "Eco/TaggedPointer.hpp"
+
+#include <concepts>
+
+namespace Eco {
+// inline namespace Eco_NS {
+
+using CompactAvlSetLink = Link<2>;
+
+namespace Private::CompactAvlSet_ {
+
+#define Eco_CAVL_HOOK(element) \
+	(reinterpret_cast<Hook*>(static_cast<CompactAvlSetLink*>(element)))
+
+#define Eco_CAVL_ELEM(hook) \
+	(static_cast<T*>(reinterpret_cast<CompactAvlSetLink*>(hook)))
+
+template<typename T>
+using Ptr = IncompleteTaggedPointer<T, uintptr_t, 1>;
+
+struct Hook;
+
+struct HookContent
+{
+	// Child pointers with the low tag bit indicating +1 subtree height.
+	Ptr<Hook> children[2];
+};
+
+struct Hook : LinkBase, HookContent {};
+
+// Upper bound on the height of an AVL tree of fewer than 2^64 hooks.
+inline constexpr size_t MaxHeight = 92;
+
+// Search path from the root, used in place of parent pointers.
+struct Path
+{
+	// Pointers to the child pointers along the path, starting at Core::m_root.
+	Ptr<Hook>* slots[MaxHeight + 1];
+
+	// Index of the last slot.
+	size_t depth;
+};
+
+
+struct Core : LinkContainer
+{
+	Linear<Ptr<Hook>, nullptr> m_root;
+	Linear<size_t> m_size;
+
+	void Insert(Hook* hook, Path& path);
+	void Remove(Path& path);
+	void Clear();
+};
+
+
+// Iterators store the whole path from the root rather than a single hook pointer,
+// which makes them large, and invalidates them on any modification of the tree.
+class IteratorCore
+{
+	Ptr<Hook>* m_root;
+
+	// Hooks along the path from the root to the current hook. Empty at the end.
+	Hook* m_path[MaxHeight];
+	size_t m_depth;
+
+public:
+	IteratorCore() = default;
+
+	IteratorCore(Ptr<Hook>* const root)
+		: m_root(root)
+		, m_depth(0)
+	{
+	}
+
+	bool operator==(const IteratorCore& other) const
+	{
+		return m_depth == other.m_depth && (m_depth == 0 || m_path[m_depth - 1] == other.m_path[m_depth - 1]);
+	}
+
+	// Move to the first hook in the l direction.
+	void Begin(bool l);
+
+	// Move to the next hook in the l direction. Advancing past the end wraps around.
+	void Advance(bool l);
+
+private:
+	void Descend(Hook* hook, bool l);
+
+	template<typename T>
+	friend struct Iterator;
+};
+
+template<typename T>
+struct Iterator : IteratorCore
+{
+	using difference_type = ptrdiff_t;
+	using value_type = T;
+	using pointer = T*;
+	using reference = T&;
+
+
+	using IteratorCore::IteratorCore;
+
+
+	[[nodiscard]] T& operator*() const
+	{
+		return *Eco_CAVL_ELEM(m_path[m_depth - 1]);
+	}
+
+	[[nodiscard]] T* operator->() const
+	{
+		return Eco_CAVL_ELEM(m_path[m_depth - 1]);
+	}
+
+
+	Iterator& operator++()
+	{
+		Advance(0);
+		return *this;
+	}
+
+	[[nodiscard]] Iterator operator++(int)
+	{
+		auto it = *this;
+		Advance(0);
+		return it;
+	}
+
+	Iterator& operator--()
+	{
+		Advance(1);
+		return *this;
+	}
+
+	[[nodiscard]] Iterator operator--(int)
+	{
+		auto it = *this;
+		Advance(1);
+		return it;
+	}
+
+
+	[[nodiscard]] bool operator==(const Iterator&) const = default;
+};
+
+
+/// @brief Ordered set without parent pointers, using two pointer hooks.
+/// Modifications retrace the search path recorded on the stack, and iterators
+/// carry the path from the root to their element.
+/// @note Any insertion or removal invalidates all iterators, as the recorded paths may
+/// no longer match the tree. The path makes each iterator about 750 bytes in size on
+/// 64 bit platforms, so iterators are best kept on the stack and not stored in bulk.
+template<std::derived_from<CompactAvlSetLink> T,
+	KeySelector<T> TKeySelector = IdentityKeySelector,
+	typename TComparator = std::compare_three_way>
+class CompactAvlSet : Core
+{
+	using KeyType = decltype(std::declval<const TKeySelector&>()(std::declval<const T&>()));
+	using RootType = Ptr<Hook>;
+
+	Eco_NO_UNIQUE_ADDRESS TKeySelector m_keySelector;
+	Eco_NO_UNIQUE_ADDRESS TComparator m_comparator;
+
+public:
+	using ElementType = T;
+
+	using       iterator = Iterator<      T>;
+	using const_iterator = Iterator<const T>;
+
+	using InsertResult = Eco::InsertResult<T>;
+
+
+	CompactAvlSet() = default;
+
+	explicit CompactAvlSet(TKeySelector keySelector)
+		: m_keySelector(static_cast<TKeySelector&&>(keySelector))
+	{
+	}
+
+	explicit CompactAvlSet(TComparator comparator)
+		: m_comparator(static_cast<TComparator&&>(comparator))
+	{
+	}
+
+	explicit CompactAvlSet(TKeySelector keySelector, TComparator comparator)
+		: m_keySelector(static_cast<TKeySelector&&>(keySelector))
+		, m_comparator(static_cast<TComparator&&>(comparator))
+	{
+	}
+
+	CompactAvlSet(CompactAvlSet&& src) noexcept = default;
+
+	CompactAvlSet& operator=(CompactAvlSet&& src) noexcept
+	{
+		if (!m_root->IsZero())
+			Core::Clear();
+		Core::operator=(static_cast<Core&&>(src));
+		return *this;
+	}
+
+	~CompactAvlSet()
+	{
+		if (!m_root->IsZero())
+			Core::Clear();
+	}
+
+
+	/// @return Size of the set.
+	[[nodiscard]] size_t Size() const
+	{
+		return m_size.Value;
+	}
+
+	/// @return True if the set is empty.
+	[[nodiscard]] bool IsEmpty() const
+	{
+		return m_size.Value == 0;
+	}
+
+
+	/// @brief Find element by homogeneous key.
+	/// @param key Lookup key.
+	/// @return Pointer to element, or null if not found.
+	[[nodiscard]] T* Find(const KeyType& key)
+	{
+		return FindInternal(key);
+	}
+
+	/// @brief Find element by homogeneous key.
+	/// @param key Lookup key.
+	/// @return Pointer to element, or null if not found.
+	[[nodiscard]] const T* Find(const KeyType& key) const
+	{
+		return FindInternal(key);
+	}
+
+	/// @brief Find element by heterogeneous key.
+	/// @param key Lookup key.
+	/// @return Pointer to element or null.
+	template<typename TKey>
+	[[nodiscard]] T* FindEquivalent(const TKey& key)
+		requires (requires (const KeyType& containerKey) { m_comparator(key, containerKey); })
+	{
+		return FindInternal(key);
+	}
+
+	/// @brief Find element by heterogeneous key.
+	/// @param key Lookup key.
+	/// @return Pointer to element or null.
+	template<typename TKey>
+	[[nodiscard]] const T* FindEquivalent(const TKey& key) const
+		requires (requires (const KeyType& containerKey) { m_comparator(key, containerKey); })
+	{
+		return FindInternal(key);
+	}
+
+
+	/// @brief Insert new element into the tree.
+	/// @param element Element to be inserted.
+	/// @pre @p element is not part of any container.
+	InsertResult Insert(T* const element)
+	{
+		Path path;
+		if (Hook* const hook = FindPath(m_keySelector(*element), path))
+			return { Eco_CAVL_ELEM(hook), false };
+
+		Core::Insert(Eco_CAVL_HOOK(element), path);
+		return { element, true };
+	}
+
+	/// @brief Remove an element from the tree.
+	/// @param element Element to be removed.
+	/// @pre @p element is part of this tree.
+	void Remove(T* const element)
+	{
+		LinkCheck(*element, *this);
+
+		// Without parent pointers the path must be found by searching for the key.
+		Path path;
+		[[maybe_unused]] Hook* const hook = FindPath(m_keySelector(*element), path);
+		Eco_Assert(hook == Eco_CAVL_HOOK(element));
+
+		Core::Remove(path);
+	}
+
+	/// @brief Remove all elements from the tree.
+	using Core::Clear;
+
+
+	[[nodiscard]] iterator begin()
+	{
+		iterator it(&m_root.Value);
+		it.Begin(0);
+		return it;
+	}
+
+	[[nodiscard]] const_iterator begin() const
+	{
+		const_iterator it(const_cast<RootType*>(&m_root.Value));
+		it.Begin(0);
+		return it;
+	}
+
+	[[nodiscard]] iterator end()
+	{
+		return iterator(&m_root.Value);
+	}
+
+	[[nodiscard]] const_iterator end() const
+	{
+		return const_iterator(const_cast<RootType*>(&m_root.Value));
+	}
+
+
+	[[nodiscard]] friend size_t size(const CompactAvlSet& set)
+	{
+		return set.Size();
+	}
+
+	friend void swap(CompactAvlSet& lhs, CompactAvlSet& rhs) noexcept
+	{
+		using std::swap;
+		swap(static_cast<Core&>(lhs), static_cast<Core&>(rhs));
+		swap(lhs.m_keySelector, rhs.m_keySelector);
+		swap(lhs.m_comparator, rhs.m_comparator);
+	}
+
+private:
+	template<typename TKey>
+	T* FindInternal(const TKey& key) const
+	{
+		Hook* hook = m_root->Ptr();
+
+		while (hook != nullptr)
+		{
+			auto const ordering = m_comparator(key, m_keySelector(*Eco_CAVL_ELEM(hook)));
+			if (ordering == 0) break;
+
+			hook = hook->children[ordering > 0].Ptr();
+		}
+
+		return Eco_CAVL_ELEM(hook);
+	}
+
+	// Record the search path for a key.
+	// Returns the matching hook, which is the last on the path, or null.
+	template<typename TKey>
+	Hook* FindPath(const TKey& key, Path& path)
+	{
+		Ptr<Hook>* slot = &m_root.Value;
+		size_t depth = 0;
+
+		path.slots[0] = slot;
+		while (Hook* const hook = slot->Ptr())
+		{
+			auto const ordering = m_comparator(key, m_keySelector(*Eco_CAVL_ELEM(hook)));
+			if (ordering == 0)
+			{
+				path.depth = depth;
+				return hook;
+			}
+
+			slot = &hook->children[ordering > 0];
+			path.slots[++depth] = slot;
+		}
+
+		path.depth = depth;
+		return nullptr;
+	}
+};
+
+#undef Eco_CAVL_HOOK
+#undef Eco_CAVL_ELEM
+
+} // namespace Private::CompactAvlSet_
+
+using Private::CompactAvlSet_::CompactAvlSet;
+
+// } // inline namespace Eco_NS
+} // namespace Eco
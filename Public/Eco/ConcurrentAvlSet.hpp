@@ -0,0 +1,275 @@
+#pragma once
+
+#include "Eco/Atomic.hpp"
+#include "Eco/AvlSet.hpp"
+
+#include <atomic>
+#include <thread>
+#include <type_traits>
+
+#include <climits>
+
+namespace Eco {
+// inline namespace Eco_NS {
+
+namespace Private::AvlSet_ {
+
+#define Eco_AVL_HOOK(element) \
+	(reinterpret_cast<Hook*>(static_cast<AvlSetLink*>(element)))
+
+#define Eco_AVL_ELEM(hook) \
+	(static_cast<T*>(reinterpret_cast<AvlSetLink*>(hook)))
+
+static_assert(std::is_trivially_copyable_v<Ptr<Hook>>);
+
+/// @brief Ordered set with a single writer and any number of optimistic readers.
+/// Modifications are bracketed by a sequence counter, as in a sequence lock. The writer stores the child pointers
+/// using relaxed atomic stores, and readers traverse the tree using atomic loads of the child
+/// pointers, retrying if the counter shows that a modification overlapped.
+/// Readers never block the writer, but wait for a modification in progress to finish,
+/// so they are not lock-free.
+/// @note Modifications must not run concurrently with each other.
+/// @note A removed element may still be visited by readers which started before its removal.
+///       It must not be destroyed or have its key modified until those readers have finished,
+///       for example by deferring its destruction using epoch based reclamation.
+template<std::derived_from<AvlSetLink> T,
+	KeySelector<T> TKeySelector = IdentityKeySelector,
+	typename TComparator = std::compare_three_way>
+class ConcurrentAvlSet : Core
+{
+	using KeyType = decltype(std::declval<const TKeySelector&>()(std::declval<const T&>()));
+	using RootType = Ptr<Hook>;
+
+	// Upper bound on the number of hooks on a search path, which is used to
+	// abandon a search which was led astray by a concurrent modification.
+	static constexpr size_t MaxSearchLength = 2 * sizeof(size_t) * CHAR_BIT;
+
+	// Incremented before and after each modification.
+	// An odd value indicates that a modification is in progress.
+	alignas(64) atomic<size_t> m_sequence = 0;
+
+	Eco_NO_UNIQUE_ADDRESS TKeySelector m_keySelector;
+	Eco_NO_UNIQUE_ADDRESS TComparator m_comparator;
+
+public:
+	using ElementType = T;
+
+	using InsertResult = Eco::InsertResult<T>;
+
+
+	ConcurrentAvlSet() = default;
+
+	explicit ConcurrentAvlSet(TKeySelector keySelector)
+		: m_keySelector(static_cast<TKeySelector&&>(keySelector))
+	{
+	}
+
+	explicit ConcurrentAvlSet(TComparator comparator)
+		: m_comparator(static_cast<TComparator&&>(comparator))
+	{
+	}
+
+	explicit ConcurrentAvlSet(TKeySelector keySelector, TComparator comparator)
+		: m_keySelector(static_cast<TKeySelector&&>(keySelector))
+		, m_comparator(static_cast<TComparator&&>(comparator))
+	{
+	}
+
+	ConcurrentAvlSet(const ConcurrentAvlSet&) = delete;
+	ConcurrentAvlSet& operator=(const ConcurrentAvlSet&) = delete;
+
+	~ConcurrentAvlSet()
+	{
+		if (!m_root->IsZero())
+			Core::Clear();
+	}
+
+
+	/// @return Size of the set.
+	/// @note May only be called by the writer.
+	[[nodiscard]] size_t Size() const
+	{
+		return m_size.Value;
+	}
+
+	/// @return True if the set is empty.
+	/// @note May only be called by the writer.
+	[[nodiscard]] bool IsEmpty() const
+	{
+		return m_size.Value == 0;
+	}
+
+
+	/// @brief Find element by homogeneous key. Safe to call concurrently with a modification.
+	/// @param key Lookup key.
+	/// @return Pointer to element, or null if not found.
+	[[nodiscard]] T* Find(const KeyType& key) const
+	{
+		return ReadInternal(key, true);
+	}
+
+	/// @brief Find element by heterogeneous key. Safe to call concurrently with a modification.
+	/// @param key Lookup key.
+	/// @return Pointer to element or null.
+	template<typename TKey>
+	[[nodiscard]] T* FindEquivalent(const TKey& key) const
+		requires (requires (const KeyType& containerKey) { m_comparator(key, containerKey); })
+	{
+		return ReadInternal(key, true);
+	}
+
+	/// @brief Find the first element whose key is not ordered before a key.
+	/// Safe to call concurrently with a modification.
+	/// @param key Lookup key.
+	/// @return Pointer to element, or null if there is none.
+	[[nodiscard]] T* LowerBound(const KeyType& key) const
+	{
+		return ReadInternal(key, false);
+	}
+
+	/// @brief Find the first element whose key is not ordered before a heterogeneous key.
+	/// Safe to call concurrently with a modification.
+	/// @param key Lookup key.
+	/// @return Pointer to element, or null if there is none.
+	template<typename TKey>
+	[[nodiscard]] T* LowerBoundEquivalent(const TKey& key) const
+		requires (requires (const KeyType& containerKey) { m_comparator(key, containerKey); })
+	{
+		return ReadInternal(key, false);
+	}
+
+
+	/// @brief Insert new element into the tree.
+	/// @param element Element to be inserted.
+	/// @pre @p element is not part of any container.
+	InsertResult Insert(T* const element)
+	{
+		auto&& key = m_keySelector(*element);
+
+		Ptr<Hook>* parent = &m_root.Value;
+		uintptr_t l = 0;
+
+		while (!parent[l].IsZero())
+		{
+			Hook* const child = parent[l].Ptr();
+
+			auto const ordering = m_comparator(key, m_keySelector(*Eco_AVL_ELEM(child)));
+			if (ordering == 0) return { Eco_AVL_ELEM(child), false };
+
+			parent = child->children;
+			l = ordering > 0;
+		}
+
+		size_t const sequence = BeginWrite();
+		Core::Insert(Eco_AVL_HOOK(element), { parent, l }, nullptr);
+		EndWrite(sequence);
+
+		return { element, true };
+	}
+
+	/// @brief Remove an element from the tree.
+	/// @param element Element to be removed.
+	/// @pre @p element is part of this tree.
+	void Remove(T* const element)
+	{
+		size_t const sequence = BeginWrite();
+		Core::Remove(Eco_AVL_HOOK(element), nullptr);
+		EndWrite(sequence);
+	}
+
+	/// @brief Remove all elements from the tree.
+	void Clear()
+	{
+		size_t const sequence = BeginWrite();
+		Core::Clear();
+		EndWrite(sequence);
+	}
+
+private:
+	size_t BeginWrite()
+	{
+		size_t const sequence = m_sequence.load(std::memory_order_relaxed);
+		Eco_Assert(sequence % 2 == 0);
+
+		m_sequence.store(sequence + 1, std::memory_order_relaxed);
+
+		// Order the increment before the modifications.
+		std::atomic_thread_fence(std::memory_order_release);
+
+		return sequence;
+	}
+
+	void EndWrite(size_t const sequence)
+	{
+		m_sequence.store(sequence + 2, std::memory_order_release);
+	}
+
+	// The child pointers are stored after the release fence of BeginWrite, so loading them
+	// with acquire ordering makes the keys of newly inserted elements visible to the reader.
+	static RootType Load(const RootType& ptr)
+	{
+		return std::atomic_ref<RootType>(const_cast<RootType&>(ptr)).load(std::memory_order_acquire);
+	}
+
+	// Find the matching hook if exact, or otherwise the lower bound of the key.
+	// Returns false if the search was abandoned.
+	template<typename TKey>
+	bool SearchInternal(const TKey& key, bool const exact, Hook*& result) const
+	{
+		Hook* bound = nullptr;
+		Hook* hook = Load(m_root.Value).Ptr();
+
+		for (size_t length = 0; hook != nullptr; ++length)
+		{
+			if (length == MaxSearchLength)
+				return false;
+
+			auto const ordering = m_comparator(key, m_keySelector(*Eco_AVL_ELEM(hook)));
+			if (ordering <= 0)
+			{
+				bound = hook;
+				if (ordering == 0) break;
+			}
+
+			hook = Load(hook->children[ordering > 0]).Ptr();
+		}
+
+		result = exact ? hook : bound;
+		return true;
+	}
+
+	template<typename TKey>
+	T* ReadInternal(const TKey& key, bool const exact) const
+	{
+		while (true)
+		{
+			size_t const sequence = m_sequence.load(std::memory_order_acquire);
+
+			// Wait for the modification in progress to finish.
+			if (sequence % 2 != 0)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+
+			Hook* hook;
+			bool const complete = SearchInternal(key, exact, hook);
+
+			// Order the reads of the tree before the validation.
+			std::atomic_thread_fence(std::memory_order_acquire);
+
+			if (complete && m_sequence.load(std::memory_order_relaxed) == sequence)
+				return Eco_AVL_ELEM(hook);
+		}
+	}
+};
+
+#undef Eco_AVL_HOOK
+#undef Eco_AVL_ELEM
+
+} // namespace Private::AvlSet_
+
+using Private::AvlSet_::ConcurrentAvlSet;
+
+// } // inline namespace Eco_NS
+} // namespace Eco
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <concepts>
+
+#include <cstddef>
+
+namespace Eco {
+
+/// @brief Type erased unit of work submitted to an executor.
+struct ExecutorTask
+{
+	void(*Function)(void* context);
+	void* Context;
+
+	void operator()() const
+	{
+		Function(Context);
+	}
+};
+
+/// @brief An executor invokes each submitted task exactly once, usually on another thread.
+/// @note Operations accepting an executor block until all of their tasks have returned.
+template<typename TExecutor>
+concept Executor = std::invocable<TExecutor&, ExecutorTask>;
+
+namespace Private {
+
+class ExecutorRef
+{
+	void* m_executor;
+	void(*m_submit)(void* executor, ExecutorTask task);
+
+public:
+	template<Executor TExecutor>
+	explicit ExecutorRef(TExecutor& executor)
+		: m_executor(const_cast<void*>(static_cast<const void*>(&executor)))
+		, m_submit([](void* const executor, ExecutorTask const task) { (*static_cast<TExecutor*>(executor))(task); })
+	{
+	}
+
+	/// @return Number of tasks worth splitting work into.
+	size_t Concurrency() const;
+
+	/// @brief Invoke function for each index in [0, count) using the executor.
+	/// The calling thread participates and returns once all tasks have returned.
+	void Run(size_t count, void(*function)(void* context, size_t index), void* context) const;
+};
+
+} // namespace Private
+} // namespace Eco
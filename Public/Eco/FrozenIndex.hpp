@@ -0,0 +1,210 @@
+#pragma once
+
+#include "Eco/Assert.hpp"
+#include "Eco/Attributes.hpp"
+#include "Eco/KeySelector.hpp"
+#include "Eco/Private/Config.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <compare>
+#include <concepts>
+#include <new>
+#include <ranges>
+#include <vector>
+
+namespace Eco {
+// inline namespace Eco_NS {
+
+/// @brief Immutable index over the elements of an ordered container.
+/// Copies of the keys are stored contiguously in Eytzinger (breadth first) order,
+/// which is searched without branching on the comparison results.
+/// The index refers to, but does not own or link, the elements.
+template<typename T,
+	KeySelector<T> TKeySelector = IdentityKeySelector,
+	typename TComparator = std::compare_three_way>
+	requires std::copyable<std::remove_cvref_t<decltype(std::declval<const TKeySelector&>()(std::declval<const T&>()))>>
+class FrozenIndex
+{
+	using KeyType = std::remove_cvref_t<decltype(std::declval<const TKeySelector&>()(std::declval<const T&>()))>;
+
+	static constexpr size_t CacheLineSize = 64;
+
+	// Number of keys in a cache line, used for prefetching descendants.
+	static constexpr size_t PrefetchStride = std::max<size_t>(CacheLineSize / sizeof(KeyType), 1);
+
+	// Allocates the keys at cache line boundaries. When the key size divides the cache line
+	// size, the PrefetchStride descendants of key k starting at index k * PrefetchStride then
+	// occupy exactly one cache line, as the unused index zero starts a cache line as well.
+	template<typename U>
+	struct KeyAllocator
+	{
+		using value_type = U;
+
+		static constexpr std::align_val_t Alignment{ std::max(CacheLineSize, alignof(U)) };
+
+		KeyAllocator() = default;
+
+		template<typename V>
+		KeyAllocator(const KeyAllocator<V>&)
+		{
+		}
+
+		U* allocate(size_t const count)
+		{
+			return static_cast<U*>(::operator new(count * sizeof(U), Alignment));
+		}
+
+		void deallocate(U* const keys, size_t)
+		{
+			::operator delete(keys, Alignment);
+		}
+
+		friend bool operator==(const KeyAllocator&, const KeyAllocator&) = default;
+	};
+
+	// Both arrays are indexed from one. Index zero is unused.
+	std::vector<KeyType, KeyAllocator<KeyType>> m_keys;
+	std::vector<T*> m_elements;
+
+	Eco_NO_UNIQUE_ADDRESS TKeySelector m_keySelector;
+	Eco_NO_UNIQUE_ADDRESS TComparator m_comparator;
+
+public:
+	using ElementType = T;
+
+
+	FrozenIndex() = default;
+
+	/// @brief Build an index from an ordered range of elements.
+	/// @param range Range of elements, such as an @ref AvlSet, @ref WbSet or a flattened @ref List.
+	/// @pre The keys of the elements of @p range are unique and in ascending order.
+	template<std::ranges::input_range TRange>
+	explicit FrozenIndex(TRange&& range, TKeySelector keySelector = {}, TComparator comparator = {})
+		requires std::convertible_to<std::ranges::range_reference_t<TRange>, T&>
+		: m_keySelector(static_cast<TKeySelector&&>(keySelector))
+		, m_comparator(static_cast<TComparator&&>(comparator))
+	{
+		std::vector<T*> sorted;
+		if constexpr (std::ranges::sized_range<TRange>)
+			sorted.reserve(std::ranges::size(range));
+
+		for (T& element : range)
+		{
+			Eco_Assert(sorted.empty() || m_comparator(m_keySelector(*sorted.back()), m_keySelector(element)) < 0);
+			sorted.push_back(&element);
+		}
+
+		size_t const size = sorted.size();
+		if (size == 0) return;
+
+		m_keys.reserve(size + 1);
+		m_keys.resize(1, m_keySelector(*sorted[0]));
+		m_elements.resize(size + 1);
+
+		// An in-order traversal of the implicit tree visits the indices in key order.
+		size_t next = 0;
+		auto const fill = [&](auto const& fill, size_t const k) -> void
+		{
+			if (k > size) return;
+
+			fill(fill, 2 * k);
+			m_elements[k] = sorted[next++];
+			fill(fill, 2 * k + 1);
+		};
+		fill(fill, 1);
+
+		for (size_t k = 1; k <= size; ++k)
+			m_keys.push_back(m_keySelector(*m_elements[k]));
+	}
+
+
+	/// @return Number of elements in the index.
+	[[nodiscard]] size_t Size() const
+	{
+		return m_elements.empty() ? 0 : m_elements.size() - 1;
+	}
+
+	/// @return True if the index is empty.
+	[[nodiscard]] bool IsEmpty() const
+	{
+		return m_elements.empty();
+	}
+
+
+	/// @brief Find element by homogeneous key.
+	/// @param key Lookup key.
+	/// @return Pointer to element, or null if not found.
+	[[nodiscard]] T* Find(const KeyType& key) const
+	{
+		return FindInternal(key);
+	}
+
+	/// @brief Find element by heterogeneous key.
+	/// @param key Lookup key.
+	/// @return Pointer to element or null.
+	template<typename TKey>
+	[[nodiscard]] T* FindEquivalent(const TKey& key) const
+		requires (requires (const KeyType& containerKey) { m_comparator(key, containerKey); })
+	{
+		return FindInternal(key);
+	}
+
+	/// @brief Find the first element whose key is not ordered before a key.
+	/// @param key Lookup key.
+	/// @return Pointer to element, or null if there is none.
+	[[nodiscard]] T* LowerBound(const KeyType& key) const
+	{
+		return m_elements.empty() ? nullptr : m_elements[LowerBoundInternal(key)];
+	}
+
+	/// @brief Find the first element whose key is not ordered before a heterogeneous key.
+	/// @param key Lookup key.
+	/// @return Pointer to element, or null if there is none.
+	template<typename TKey>
+	[[nodiscard]] T* LowerBoundEquivalent(const TKey& key) const
+		requires (requires (const KeyType& containerKey) { m_comparator(key, containerKey); })
+	{
+		return m_elements.empty() ? nullptr : m_elements[LowerBoundInternal(key)];
+	}
+
+
+	[[nodiscard]] friend size_t size(const FrozenIndex& index)
+	{
+		return index.Size();
+	}
+
+private:
+	// Returns the index of the first key not ordered before the key, or zero if there is none.
+	template<typename TKey>
+	size_t LowerBoundInternal(const TKey& key) const
+	{
+		const KeyType* const keys = m_keys.data();
+		size_t const size = m_keys.size() - 1;
+
+		size_t k = 1;
+		while (k <= size)
+		{
+			// The descendants several levels down share a cache line.
+			// See KeyAllocator for the alignment making this exact.
+			Eco_PREFETCH(keys + std::min(k * PrefetchStride, size));
+
+			k = 2 * k + (m_comparator(key, keys[k]) > 0);
+		}
+
+		// Cancel the right turns taken after the last left turn.
+		return k >> (std::countr_one(k) + 1);
+	}
+
+	template<typename TKey>
+	T* FindInternal(const TKey& key) const
+	{
+		if (m_elements.empty()) return nullptr;
+
+		size_t const k = LowerBoundInternal(key);
+		return k != 0 && m_comparator(key, m_keys[k]) == 0 ? m_elements[k] : nullptr;
+	}
+};
+
+// } // inline namespace Eco_NS
+} // namespace Eco
@@ -48,6 +48,7 @@ struct Core : LinkContainer
 
 	void Push(Hook* hook, Comparator* comparator);
 	void Remove(Hook* hook, Comparator* comparator);
+	void Relocate(Hook* hook, Hook* newHook);
 	Hook* Pop(Comparator* comparator);
 };
 
@@ -139,6 +140,16 @@ public:
 		Core::Remove(Eco_HEAP_HOOK(element), Comparator);
 	}
 
+	/// @brief Replace an element by a copy at a new address, such as after moving it in memory.
+	/// The links referring to the element are redirected to the copy in constant time.
+	/// @param element Element to be replaced.
+	/// @param newElement Bitwise copy of @p element, which takes its place in the heap.
+	/// @pre @p element is part of this heap.
+	void Relocate(T* const element, T* const newElement)
+	{
+		Core::Relocate(Eco_HEAP_HOOK(element), Eco_HEAP_HOOK(newElement));
+	}
+
 	/// @brief Pop the minimum element of the heap.
 	/// @return The minimum element.
 	/// @pre The heap is not empty.
@@ -0,0 +1,276 @@
+#pragma once
+
+#include "Eco/AvlSet.hpp"
+
+namespace Eco {
+// inline namespace Eco_NS {
+
+/// @brief Link of an element of an @ref IntervalSet.
+/// @tparam TEndpoint Type of the interval endpoints.
+template<std::semiregular TEndpoint>
+class IntervalSetLink : public AvlSetLink
+{
+	// Maximum end of the intervals in the subtree rooted at this element.
+	[[maybe_unused]]
+	TEndpoint m_maxEnd;
+
+	friend TEndpoint& IntervalSetMaxEnd(IntervalSetLink& link)
+	{
+		return link.m_maxEnd;
+	}
+};
+
+namespace Private::AvlSet_ {
+
+#define Eco_AVL_HOOK(element) \
+	(reinterpret_cast<Hook*>(static_cast<AvlSetLink*>(element)))
+
+#define Eco_AVL_ELEM(hook) \
+	(static_cast<T*>(reinterpret_cast<AvlSetLink*>(hook)))
+
+/// @brief Ordered set of half-open intervals [lo, hi) supporting overlap queries.
+/// The elements are ordered by their starts, with intervals of equivalent starts kept
+/// in insertion order. Each element stores the maximum end of the intervals in its
+/// subtree, which is maintained through rotations by the AVL augmentation.
+/// @tparam TLoSelector Selects the inclusive start of the interval of an element.
+/// @tparam THiSelector Selects the exclusive end of the interval of an element.
+/// @note The selectors and the comparator are stateless, as they are used by the augmentation.
+template<typename T,
+	KeySelector<T> TLoSelector,
+	KeySelector<T> THiSelector,
+	typename TComparator = std::compare_three_way>
+	requires std::derived_from<T, IntervalSetLink<std::remove_cvref_t<decltype(std::declval<const TLoSelector&>()(std::declval<const T&>()))>>>
+		&& std::default_initializable<TLoSelector>
+		&& std::default_initializable<THiSelector>
+		&& std::default_initializable<TComparator>
+class IntervalSet : Core
+{
+	using EndpointType = std::remove_cvref_t<decltype(std::declval<const TLoSelector&>()(std::declval<const T&>()))>;
+	using LinkType = IntervalSetLink<EndpointType>;
+	using RootType = Ptr<Hook>;
+
+public:
+	using ElementType = T;
+
+	using       iterator = Iterator<      T>;
+	using const_iterator = Iterator<const T>;
+
+
+	IntervalSet() = default;
+
+	IntervalSet(IntervalSet&& src) noexcept = default;
+
+	IntervalSet& operator=(IntervalSet&& src) noexcept
+	{
+		if (!m_root->IsZero())
+			Core::Clear();
+		Core::operator=(static_cast<Core&&>(src));
+		return *this;
+	}
+
+	~IntervalSet()
+	{
+		if (!m_root->IsZero())
+			Core::Clear();
+	}
+
+
+	/// @return Size of the set.
+	[[nodiscard]] size_t Size() const
+	{
+		return m_size.Value;
+	}
+
+	/// @return True if the set is empty.
+	[[nodiscard]] bool IsEmpty() const
+	{
+		return m_size.Value == 0;
+	}
+
+
+	/// @brief Find any interval overlapping the interval [lo, hi) in O(log n) time.
+	/// @param lo Inclusive start of the query interval.
+	/// @param hi Exclusive end of the query interval.
+	/// @return Pointer to an overlapping element, or null if there is none.
+	[[nodiscard]] T* FindAnyOverlapping(const EndpointType& lo, const EndpointType& hi) const
+	{
+		Hook* hook = m_root->Ptr();
+
+		while (hook != nullptr)
+		{
+			T& element = *Eco_AVL_ELEM(hook);
+			if (Compare(Lo(element), hi) >= 0)
+			{
+				// This and all following intervals start at or after the end of the query.
+				hook = hook->children[0].Ptr();
+				continue;
+			}
+
+			if (Compare(Hi(element), lo) > 0)
+				return &element;
+
+			// An interval of the left subtree ending after lo overlaps the query,
+			// because it starts no later than this interval, which starts before hi.
+			Hook* const child = hook->children[0].Ptr();
+			hook = child != nullptr && Compare(MaxEnd(child), lo) > 0
+				? child
+				: hook->children[1].Ptr();
+		}
+
+		return nullptr;
+	}
+
+	/// @brief Invoke a function for each interval overlapping the interval [lo, hi), ordered by start.
+	/// @param lo Inclusive start of the query interval.
+	/// @param hi Exclusive end of the query interval.
+	/// @param function Function invoked with a reference to each overlapping element.
+	/// @note Subtrees are skipped if all of their intervals end before @p lo or start after @p hi,
+	///       so each of the k results costs at most O(log n) time.
+	template<typename TFunction>
+	void FindOverlapping(const EndpointType& lo, const EndpointType& hi, TFunction&& function) const
+		requires std::invocable<TFunction&, T&>
+	{
+		OverlapInternal(m_root->Ptr(), lo, hi, false, function);
+	}
+
+	/// @brief Invoke a function for each interval containing a point, ordered by start.
+	/// @param point Query point.
+	/// @param function Function invoked with a reference to each containing element.
+	template<typename TFunction>
+	void Stab(const EndpointType& point, TFunction&& function) const
+		requires std::invocable<TFunction&, T&>
+	{
+		OverlapInternal(m_root->Ptr(), point, point, true, function);
+	}
+
+
+	/// @brief Insert new element into the tree after any elements with equivalent starts.
+	/// @param element Element to be inserted.
+	/// @pre @p element is not part of any container.
+	/// @pre The start of the interval of @p element is not ordered after its end.
+	void Insert(T* const element)
+	{
+		auto&& lo = Lo(*element);
+		Eco_Assert(Compare(lo, Hi(*element)) <= 0);
+
+		Ptr<Hook>* parent = &m_root.Value;
+		uintptr_t l = 0;
+
+		while (!parent[l].IsZero())
+		{
+			Hook* const child = parent[l].Ptr();
+
+			parent = child->children;
+			l = Compare(lo, Lo(*Eco_AVL_ELEM(child))) >= 0;
+		}
+
+		Core::Insert(Eco_AVL_HOOK(element), { parent, l }, AugmentHook);
+	}
+
+	/// @brief Remove an element from the tree.
+	/// @param element Element to be removed.
+	/// @pre @p element is part of this tree.
+	void Remove(T* const element)
+	{
+		Core::Remove(Eco_AVL_HOOK(element), AugmentHook);
+	}
+
+	/// @brief Remove all elements from the tree.
+	using Core::Clear;
+
+
+	[[nodiscard]] iterator begin()
+	{
+		return iterator(IteratorBegin(&m_root.Value));
+	}
+
+	[[nodiscard]] const_iterator begin() const
+	{
+		return const_iterator(IteratorBegin(const_cast<RootType*>(&m_root.Value)));
+	}
+
+	[[nodiscard]] iterator end()
+	{
+		return iterator(&m_root.Value);
+	}
+
+	[[nodiscard]] const_iterator end() const
+	{
+		return const_iterator(const_cast<RootType*>(&m_root.Value));
+	}
+
+
+	[[nodiscard]] friend size_t size(const IntervalSet& set)
+	{
+		return set.Size();
+	}
+
+private:
+	template<typename TLhs, typename TRhs>
+	static auto Compare(const TLhs& lhs, const TRhs& rhs)
+	{
+		return TComparator()(lhs, rhs);
+	}
+
+	static decltype(auto) Lo(const T& element)
+	{
+		return TLoSelector()(element);
+	}
+
+	static decltype(auto) Hi(const T& element)
+	{
+		return THiSelector()(element);
+	}
+
+	static EndpointType& MaxEnd(Hook* const hook)
+	{
+		return IntervalSetMaxEnd(static_cast<LinkType&>(*Eco_AVL_ELEM(hook)));
+	}
+
+	static void AugmentHook(Hook* const hook)
+	{
+		EndpointType maxEnd = Hi(*Eco_AVL_ELEM(hook));
+
+		for (Ptr<Hook> const child : hook->children)
+		{
+			if (!child.IsZero() && Compare(MaxEnd(child.Ptr()), maxEnd) > 0)
+				maxEnd = MaxEnd(child.Ptr());
+		}
+
+		MaxEnd(hook) = static_cast<EndpointType&&>(maxEnd);
+	}
+
+	// Visit the intervals of the subtree overlapping [lo, hi), or [lo, hi] if closed.
+	template<typename TFunction>
+	void OverlapInternal(Hook* hook, const EndpointType& lo, const EndpointType& hi,
+		bool const closed, TFunction& function) const
+	{
+		while (hook != nullptr)
+		{
+			// All intervals of the subtree end at or before the start of the query.
+			if (Compare(MaxEnd(hook), lo) <= 0) return;
+
+			OverlapInternal(hook->children[0].Ptr(), lo, hi, closed, function);
+
+			// This and all following intervals start after the end of the query.
+			T& element = *Eco_AVL_ELEM(hook);
+			auto const ordering = Compare(Lo(element), hi);
+			if (closed ? ordering > 0 : ordering >= 0) return;
+
+			if (Compare(Hi(element), lo) > 0)
+				function(element);
+
+			hook = hook->children[1].Ptr();
+		}
+	}
+};
+
+#undef Eco_AVL_HOOK
+#undef Eco_AVL_ELEM
+
+} // namespace Private::AvlSet_
+
+using Private::AvlSet_::IntervalSet;
+
+// } // inline namespace Eco_NS
+} // namespace Eco
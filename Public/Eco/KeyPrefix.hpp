@@ -0,0 +1,72 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <string_view>
+#include <type_traits>
+
+#include <cstdint>
+#include <cstring>
+
+namespace Eco {
+// inline namespace Eco_NS {
+
+/// @brief Key prefix policy which caches no key prefixes.
+struct NoKeyPrefix {};
+
+/// @brief Key prefix policy caching a prefix of each key in the hook of its element,
+/// so that most comparisons during a search need not touch the element itself.
+/// @c Prefix must preserve the order of the keys: if the prefix of a key is less than
+/// the prefix of another key, the key must be ordered before the other key.
+/// Keys with equal prefixes are compared using the comparator of the container.
+template<typename TKeyPrefix, typename TKey>
+concept KeyPrefixPolicy = std::is_same_v<TKeyPrefix, NoKeyPrefix> ||
+	requires (const TKey& key)
+	{
+		{ TKeyPrefix::Prefix(key) } -> std::same_as<uint64_t>;
+	};
+
+/// @brief Key prefix policy for strings compared lexicographically by unsigned bytes,
+/// such as @c std::string with the default comparator.
+struct StringKeyPrefix
+{
+	/// @return First eight bytes of the string in big endian order, padded with zeros.
+	static uint64_t Prefix(std::string_view const key)
+	{
+		uint64_t prefix = 0;
+
+		size_t const size = std::min(key.size(), sizeof(prefix));
+		for (size_t i = 0; i < size; ++i)
+			prefix |= static_cast<uint64_t>(static_cast<unsigned char>(key[i])) << (56 - i * 8);
+
+		return prefix;
+	}
+};
+
+namespace Private {
+
+// Number of link words storing a key prefix.
+inline constexpr size_t KeyPrefixLinkSize = sizeof(uint64_t) / sizeof(uintptr_t);
+
+// Key prefix stored in link words following a hook.
+struct KeyPrefixStorage
+{
+	uintptr_t words[KeyPrefixLinkSize];
+
+	uint64_t Load() const
+	{
+		uint64_t prefix;
+		memcpy(&prefix, words, sizeof(prefix));
+		return prefix;
+	}
+
+	void Store(uint64_t const prefix)
+	{
+		memcpy(words, &prefix, sizeof(prefix));
+	}
+};
+
+} // namespace Private
+
+// } // inline namespace Eco_NS
+} // namespace Eco
@@ -121,6 +121,16 @@ private:
 #endif
 	}
 
+	// Transfers the membership of a link to its copy at a new address.
+	friend void LinkRelocate(LinkBase& link, LinkBase& newLink, const LinkContainer& container)
+	{
+#if Eco_CONFIG_LINK_DEBUG
+		if (link.m_shared != nullptr)
+			newLink.m_shared = std::exchange(link.m_shared, nullptr);
+		Eco_Assert(newLink.m_shared == container.m_shared);
+#endif
+	}
+
 	friend void LinkCheck(const LinkBase& link, const LinkContainer& container)
 	{
 #if Eco_CONFIG_LINK_DEBUG
@@ -35,13 +35,22 @@ struct Core : LinkContainer
 		m_root.siblings[1] = &m_root;
 	}
 
+	explicit Core(LinkContainer&& container)
+		: LinkContainer(static_cast<LinkContainer&&>(container))
+	{
+		m_root.siblings[0] = &m_root;
+		m_root.siblings[1] = &m_root;
+	}
+
 	Core(Core&& src);
 
 	Core& operator=(Core&&) = delete;
 
 	void Adopt(Hook* head, size_t size);
+	Hook* Release();
 	void Insert(Hook* prev, Hook* hook, bool before);
 	void Remove(Hook* hook);
+	void Relocate(Hook* hook, Hook* newHook);
 };
 
 
@@ -134,7 +143,11 @@ public:
 	List() = default;
 
 	// Adopting constructor for internal use only.
-	List(LinkContainer&& container, Hook* const list, size_t const size);
+	List(LinkContainer&& container, Hook* const list, size_t const size)
+		: Core(static_cast<LinkContainer&&>(container))
+	{
+		if (list != nullptr) Core::Adopt(list, size);
+	}
 
 
 	/// @return Size of the list.
@@ -235,8 +248,27 @@ public:
 		Core::Remove(Eco_LIST_HOOK(element));
 	}
 
+	/// @brief Replace an element by a copy at a new address, such as after moving it in memory.
+	/// The links referring to the element are redirected to the copy in constant time.
+	/// @param element Element to be replaced.
+	/// @param newElement Bitwise copy of @p element, which takes its place in the list.
+	/// @pre @p element is part of this list.
+	/// @note Iterators referring to @p element are invalidated.
+	void Relocate(T* const element, T* const newElement)
+	{
+		Core::Relocate(Eco_LIST_HOOK(element), Eco_LIST_HOOK(newElement));
+	}
+
 	List<T> RemoveList(T* const begin, T* const end);
 
+	// Releasing function for internal use only.
+	// Transfers ownership of the elements to the container and returns a circular list of them.
+	[[nodiscard]] Hook* Release(LinkContainer& container)
+	{
+		container = static_cast<LinkContainer&&>(*this);
+		return Core::Release();
+	}
+
 
 	/// @brief Create an iterator referring to an element.
 	/// @pram element Element to which the resulting iterator shall refer.
@@ -38,6 +38,7 @@ struct Core : LinkContainer
 
 	void Enqueue(Hook* hook);
 	Hook* TryDequeue();
+	void Relocate(Hook* hook, Hook* newHook);
 };
 
 template<std::derived_from<MpscQueueLink> T>
@@ -67,6 +68,18 @@ public:
 	{
 		return Eco_MPSCQ_ELEM(Core::TryDequeue());
 	}
+
+	/// @brief Replace an element by a copy at a new address, such as after moving it in memory.
+	/// @param element Element to be replaced.
+	/// @param newElement Bitwise copy of @p element, which takes its place in the queue.
+	/// @pre @p element is part of this queue.
+	/// @pre The invocation is externally synchronized and does not race with an invocation from another thread.
+	/// @note The queue is singly linked, so finding the link referring to the element takes linear time.
+	///       Producers may enqueue concurrently.
+	void Relocate(T* const element, T* const newElement)
+	{
+		Core::Relocate(Eco_MPSCQ_HOOK(element), Eco_MPSCQ_HOOK(newElement));
+	}
 };
 
 #undef Eco_MPSCQ_HOOK
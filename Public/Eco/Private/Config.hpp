@@ -26,6 +26,15 @@
 #	error unsupported compiler
 #endif
 
+#if defined(__clang__) || defined(__GNUC__)
+#	define Eco_PREFETCH(address) __builtin_prefetch(address)
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#	include <xmmintrin.h>
+#	define Eco_PREFETCH(address) _mm_prefetch(reinterpret_cast<const char*>(address), _MM_HINT_T0)
+#else
+#	define Eco_PREFETCH(address) ((void)(address))
+#endif
+
 #ifdef __clang__
 #	define Eco_CLANG_DIAG(...) _Pragma(Eco_PP_STR(clang diagnostic __VA_ARGS__))
 #else
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "Eco/Assert.hpp"
+#include "Eco/Attributes.hpp"
+#include "Eco/WbSet.hpp"
+
+#include <compare>
+#include <concepts>
+#include <memory>
+
+#include <cstdint>
+
+namespace Eco {
+// inline namespace Eco_NS {
+
+/// @brief Order statistics over a sliding window of the most recent samples.
+/// The samples are stored in a ring allocated up front, which also records their arrival
+/// order, and linked into a @ref WbSet ordered by value. Once the window is full, each new
+/// sample replaces the oldest one, so that inserting and selecting by rank take O(log n) time
+/// without allocating.
+/// @tparam TValue Type of the sample values.
+/// @tparam TComparator Three-way comparator of sample values.
+template<std::semiregular TValue, typename TComparator = std::compare_three_way>
+class QuantileWindow
+{
+	struct Sample : WbSetLink
+	{
+		TValue value;
+
+		// Arrival order, which distinguishes samples with equivalent values.
+		uint64_t sequence;
+	};
+
+	struct SampleComparator
+	{
+		Eco_NO_UNIQUE_ADDRESS TComparator comparator;
+
+		int operator()(const Sample& lhs, const Sample& rhs) const
+		{
+			auto const ordering = comparator(lhs.value, rhs.value);
+			if (ordering != 0) return (ordering > 0) - (ordering < 0);
+			return (lhs.sequence > rhs.sequence) - (lhs.sequence < rhs.sequence);
+		}
+	};
+
+	std::unique_ptr<Sample[]> m_samples;
+	size_t m_capacity;
+
+	// Ring index of the oldest sample once the window is full.
+	size_t m_oldest = 0;
+
+	uint64_t m_sequence = 0;
+
+	WbSet<Sample, IdentityKeySelector, SampleComparator> m_set;
+
+public:
+	/// @param capacity Number of most recent samples in the window.
+	/// @pre @p capacity is not zero.
+	explicit QuantileWindow(size_t const capacity, TComparator comparator = {})
+		: m_samples(new Sample[capacity])
+		, m_capacity(capacity)
+		, m_set(SampleComparator{ static_cast<TComparator&&>(comparator) })
+	{
+		Eco_Assert(capacity > 0);
+	}
+
+	QuantileWindow(const QuantileWindow&) = delete;
+	QuantileWindow& operator=(const QuantileWindow&) = delete;
+
+
+	/// @return Maximum number of samples in the window.
+	[[nodiscard]] size_t Capacity() const
+	{
+		return m_capacity;
+	}
+
+	/// @return Number of samples in the window.
+	[[nodiscard]] size_t Size() const
+	{
+		return m_set.Size();
+	}
+
+	/// @return True if the window contains no samples.
+	[[nodiscard]] bool IsEmpty() const
+	{
+		return m_set.IsEmpty();
+	}
+
+
+	/// @brief Add a sample to the window, replacing the oldest sample if the window is full.
+	/// @param value Value of the new sample.
+	void Insert(TValue value)
+	{
+		Sample* sample;
+		if (m_set.Size() < m_capacity)
+		{
+			sample = &m_samples[m_set.Size()];
+		}
+		else
+		{
+			sample = &m_samples[m_oldest];
+			m_set.Remove(sample);
+
+			if (++m_oldest == m_capacity)
+				m_oldest = 0;
+		}
+
+		sample->value = static_cast<TValue&&>(value);
+		sample->sequence = m_sequence++;
+		m_set.Insert(sample);
+	}
+
+	/// @brief Remove all samples from the window.
+	void Clear()
+	{
+		m_set.Clear();
+		m_oldest = 0;
+	}
+
+
+	/// @param rank Number of samples ordered before the selected sample.
+	/// @return Value of the sample with the given rank.
+	/// @pre @p rank is less than the size of the window.
+	[[nodiscard]] const TValue& Select(size_t const rank) const
+	{
+		Eco_Assert(rank < m_set.Size());
+		return m_set.Select(rank)->value;
+	}
+
+	/// @param quantile Fraction of the samples ordered at or before the selected sample.
+	/// @return Value of the smallest sample which is not ordered before the given fraction
+	///         of the samples, using the nearest rank method.
+	/// @pre The window is not empty.
+	/// @pre @p quantile is within [0, 1].
+	[[nodiscard]] const TValue& Quantile(double const quantile) const
+	{
+		Eco_Assert(quantile >= 0 && quantile <= 1);
+
+		size_t const size = m_set.Size();
+		Eco_Assert(size > 0);
+
+		// The nearest rank is ceil(quantile * size), counted from one.
+		double const position = quantile * static_cast<double>(size);
+		size_t rank = static_cast<size_t>(position);
+		if (static_cast<double>(rank) == position && rank > 0) --rank;
+
+		return Select(rank < size ? rank : size - 1);
+	}
+};
+
+// } // inline namespace Eco_NS
+} // namespace Eco
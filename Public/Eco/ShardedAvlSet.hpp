@@ -0,0 +1,382 @@
+#pragma once
+
+#include "Eco/Atomic.hpp"
+#include "Eco/AvlSet.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <vector>
+
+namespace Eco {
+// inline namespace Eco_NS {
+
+/// @brief Ordered set partitioning the key space between multiple @ref AvlSet shards,
+/// each protected by its own lock, allowing concurrent modification of different key ranges.
+/// Shards growing beyond the maximum size are split at their median, which is found in
+/// linear time while holding only the lock of that shard. Shards shrinking below a quarter
+/// of the maximum size are merged with a neighbour if their combined size does not exceed it.
+/// The split or merge itself takes O(log n) time using @ref AvlSet::Split or @ref AvlSet::Join,
+/// during which all other operations are excluded.
+template<std::derived_from<AvlSetLink> T,
+	KeySelector<T> TKeySelector = IdentityKeySelector,
+	typename TComparator = std::compare_three_way>
+	requires std::copyable<std::remove_cvref_t<decltype(std::declval<const TKeySelector&>()(std::declval<const T&>()))>>
+class ShardedAvlSet
+{
+	using KeyType = decltype(std::declval<const TKeySelector&>()(std::declval<const T&>()));
+	using BoundType = std::remove_cvref_t<KeyType>;
+	using SetType = AvlSet<T, TKeySelector, TComparator>;
+
+	struct Shard
+	{
+		std::mutex mutex;
+		SetType set;
+
+		// Size of the set. Modified while holding the mutex, but also read by
+		// the neighbouring shards when deciding whether they can be merged.
+		atomic<size_t> size;
+
+		// Incremented by each modification of the set.
+		size_t version = 0;
+
+		Shard(SetType&& set, size_t const size)
+			: set(static_cast<SetType&&>(set))
+			, size(size)
+		{
+		}
+	};
+
+	// Pending split of a shard at its median.
+	struct Split
+	{
+		BoundType bound;
+		size_t lowerSize;
+		size_t version;
+		size_t generation;
+	};
+
+	static constexpr size_t NoMerge = static_cast<size_t>(-1);
+
+	// Protects the shard directory. Held shared by operations on individual shards,
+	// and exclusively while splitting or merging shards.
+	mutable std::shared_mutex m_directory;
+
+	std::vector<std::unique_ptr<Shard>> m_shards;
+
+	// Lowest key of each shard except the first.
+	std::vector<BoundType> m_bounds;
+
+	// Incremented by each split or merge.
+	size_t m_generation = 0;
+
+	atomic<size_t> m_size = 0;
+	size_t m_maxShardSize;
+
+	Eco_NO_UNIQUE_ADDRESS TKeySelector m_keySelector;
+	Eco_NO_UNIQUE_ADDRESS TComparator m_comparator;
+
+public:
+	using ElementType = T;
+
+	using InsertResult = Eco::InsertResult<T>;
+
+	/// @brief Iterator visiting the elements of all shards in order.
+	/// The iterator holds the directory shared and the shard of the current element locked,
+	/// so the thread using it must not modify the set until the iterator reaches the end.
+	class Iterator
+	{
+		ShardedAvlSet* m_set = nullptr;
+		std::shared_lock<std::shared_mutex> m_directory;
+		std::unique_lock<std::mutex> m_shard;
+		size_t m_index = 0;
+		typename SetType::iterator m_iterator;
+
+	public:
+		using difference_type = ptrdiff_t;
+		using value_type = T;
+		using pointer = T*;
+		using reference = T&;
+
+
+		Iterator() = default;
+		Iterator(Iterator&&) = default;
+		Iterator& operator=(Iterator&&) = default;
+
+
+		[[nodiscard]] T& operator*() const
+		{
+			return *m_iterator;
+		}
+
+		[[nodiscard]] T* operator->() const
+		{
+			return &*m_iterator;
+		}
+
+
+		Iterator& operator++()
+		{
+			++m_iterator;
+			Settle();
+			return *this;
+		}
+
+		void operator++(int)
+		{
+			++*this;
+		}
+
+
+		[[nodiscard]] bool operator==(std::default_sentinel_t) const
+		{
+			return m_set == nullptr;
+		}
+
+	private:
+		explicit Iterator(ShardedAvlSet& set)
+			: m_set(&set)
+			, m_directory(set.m_directory)
+		{
+			m_shard = std::unique_lock(set.m_shards[0]->mutex);
+			m_iterator = set.m_shards[0]->set.begin();
+			Settle();
+		}
+
+		// Move on to the next non-empty shard if the end of the current shard was reached.
+		void Settle()
+		{
+			while (m_iterator == m_set->m_shards[m_index]->set.end())
+			{
+				m_shard.unlock();
+
+				if (++m_index == m_set->m_shards.size())
+				{
+					m_directory.unlock();
+					m_set = nullptr;
+					return;
+				}
+
+				Shard& shard = *m_set->m_shards[m_index];
+				m_shard = std::unique_lock(shard.mutex);
+				m_iterator = shard.set.begin();
+			}
+		}
+
+		friend ShardedAvlSet;
+	};
+
+
+	/// @param maxShardSize Size above which a shard is split.
+	explicit ShardedAvlSet(size_t const maxShardSize = 1 << 16,
+		TKeySelector keySelector = {}, TComparator comparator = {})
+		: m_maxShardSize(std::max<size_t>(maxShardSize, 2))
+		, m_keySelector(static_cast<TKeySelector&&>(keySelector))
+		, m_comparator(static_cast<TComparator&&>(comparator))
+	{
+		m_shards.push_back(std::make_unique<Shard>(SetType(m_keySelector, m_comparator), 0));
+	}
+
+	ShardedAvlSet(const ShardedAvlSet&) = delete;
+	ShardedAvlSet& operator=(const ShardedAvlSet&) = delete;
+
+
+	/// @return Size of the set.
+	[[nodiscard]] size_t Size() const
+	{
+		return m_size.load(std::memory_order_relaxed);
+	}
+
+	/// @return True if the set is empty.
+	[[nodiscard]] bool IsEmpty() const
+	{
+		return Size() == 0;
+	}
+
+	/// @return Current number of shards.
+	[[nodiscard]] size_t ShardCount() const
+	{
+		std::shared_lock const directory(m_directory);
+		return m_shards.size();
+	}
+
+
+	/// @brief Find element by homogeneous key.
+	/// @param key Lookup key.
+	/// @return Pointer to element, or null if not found.
+	/// @note The element may be removed by another thread as soon as this returns.
+	[[nodiscard]] T* Find(const KeyType& key) const
+	{
+		std::shared_lock const directory(m_directory);
+		Shard& shard = *m_shards[ShardIndex(key)];
+
+		std::lock_guard const lock(shard.mutex);
+		return shard.set.Find(key);
+	}
+
+
+	/// @brief Insert new element into the set.
+	/// @param element Element to be inserted.
+	/// @pre @p element is not part of any container.
+	InsertResult Insert(T* const element)
+	{
+		auto&& key = m_keySelector(*element);
+
+		InsertResult result;
+		std::optional<Split> split;
+		{
+			std::shared_lock const directory(m_directory);
+			Shard& shard = *m_shards[ShardIndex(key)];
+
+			std::lock_guard const lock(shard.mutex);
+			result = shard.set.Insert(element);
+
+			if (result.Inserted)
+			{
+				size_t const size = shard.size.load(std::memory_order_relaxed) + 1;
+				shard.size.store(size, std::memory_order_relaxed);
+				++shard.version;
+
+				if (size > m_maxShardSize)
+				{
+					// Find the median while only this shard is locked.
+					auto const median = std::next(shard.set.begin(), static_cast<ptrdiff_t>(size / 2));
+					split = Split{ m_keySelector(*median), size / 2, shard.version, m_generation };
+				}
+			}
+		}
+
+		if (result.Inserted)
+			m_size.fetch_add(1, std::memory_order_relaxed);
+
+		if (split)
+			SplitShard(*split);
+
+		return result;
+	}
+
+	/// @brief Remove an element from the set.
+	/// @param element Element to be removed.
+	/// @pre @p element is part of this set.
+	void Remove(T* const element)
+	{
+		auto&& key = m_keySelector(*element);
+
+		bool merge;
+		{
+			std::shared_lock const directory(m_directory);
+			size_t const index = ShardIndex(key);
+			Shard& shard = *m_shards[index];
+
+			std::lock_guard const lock(shard.mutex);
+			shard.set.Remove(element);
+			shard.size.store(shard.size.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+			++shard.version;
+
+			// The sizes of the neighbours may change before the directory is locked exclusively,
+			// but checking them here avoids excluding all other operations only to give up.
+			merge = FindMerge(index) != NoMerge;
+		}
+
+		m_size.fetch_sub(1, std::memory_order_relaxed);
+
+		if (merge)
+			MergeShard(key);
+	}
+
+
+	/// @return Iterator referring to the first element, which holds the set locked.
+	[[nodiscard]] Iterator begin()
+	{
+		return Iterator(*this);
+	}
+
+	[[nodiscard]] std::default_sentinel_t end()
+	{
+		return std::default_sentinel;
+	}
+
+private:
+	template<typename TKey>
+	size_t ShardIndex(const TKey& key) const
+	{
+		auto const it = std::upper_bound(m_bounds.begin(), m_bounds.end(), key,
+			[&](const TKey& lhs, const BoundType& rhs) { return m_comparator(lhs, rhs) < 0; });
+
+		return static_cast<size_t>(it - m_bounds.begin());
+	}
+
+	// Split the shard at its median, found before locking the directory exclusively.
+	// If the shard was modified in the meantime, the split is left to the next insertion.
+	void SplitShard(Split& split)
+	{
+		std::unique_lock const directory(m_directory);
+
+		if (m_generation != split.generation)
+			return;
+
+		size_t const index = ShardIndex(split.bound);
+		Shard& shard = *m_shards[index];
+
+		if (shard.version != split.version)
+			return;
+
+		size_t const size = shard.size.load(std::memory_order_relaxed);
+		SetType upper = shard.set.Split(split.bound);
+		shard.size.store(split.lowerSize, std::memory_order_relaxed);
+
+		m_shards.insert(m_shards.begin() + index + 1, std::make_unique<Shard>(
+			static_cast<SetType&&>(upper), size - split.lowerSize));
+		m_bounds.insert(m_bounds.begin() + index, static_cast<BoundType&&>(split.bound));
+		++m_generation;
+	}
+
+	// Find the smaller neighbour of a shard below a quarter of the maximum size. Returns the index
+	// of the lower shard of the pair, or NoMerge if the shard is not small enough or if the
+	// combined size would exceed the maximum. The result is only exact while the directory
+	// is locked exclusively, as otherwise the sizes of the neighbours may change concurrently.
+	size_t FindMerge(size_t const index) const
+	{
+		size_t const size = m_shards[index]->size.load(std::memory_order_relaxed);
+		if (size >= m_maxShardSize / 4)
+			return NoMerge;
+
+		size_t const lSize = index > 0
+			? m_shards[index - 1]->size.load(std::memory_order_relaxed) : NoMerge;
+		size_t const rSize = index + 1 < m_shards.size()
+			? m_shards[index + 1]->size.load(std::memory_order_relaxed) : NoMerge;
+
+		size_t const neighbourSize = std::min(lSize, rSize);
+		if (neighbourSize > m_maxShardSize - size)
+			return NoMerge;
+
+		return lSize <= rSize ? index - 1 : index;
+	}
+
+	// Merge the shard containing the key with a neighbour if it is still small enough.
+	void MergeShard(const KeyType& key)
+	{
+		std::unique_lock const directory(m_directory);
+
+		size_t const lIndex = FindMerge(ShardIndex(key));
+		if (lIndex == NoMerge)
+			return;
+
+		Shard& lShard = *m_shards[lIndex];
+		Shard& rShard = *m_shards[lIndex + 1];
+
+		lShard.set.Join(rShard.set);
+		lShard.size.store(lShard.size.load(std::memory_order_relaxed) +
+			rShard.size.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+		m_shards.erase(m_shards.begin() + lIndex + 1);
+		m_bounds.erase(m_bounds.begin() + lIndex);
+		++m_generation;
+	}
+};
+
+// } // inline namespace Eco_NS
+} // namespace Eco
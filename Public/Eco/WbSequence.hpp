@@ -0,0 +1,200 @@
+#pragma once
+
+#include "Eco/WbSet.hpp"
+
+namespace Eco {
+// inline namespace Eco_NS {
+namespace Private::WbSet_ {
+
+#define Eco_WB_HOOK(elem, ...) \
+	(reinterpret_cast<Hook __VA_ARGS__*>(static_cast<WbSetLink __VA_ARGS__*>(elem)))
+
+#define Eco_WB_ELEM(hook, ...) \
+	(static_cast<T __VA_ARGS__*>(reinterpret_cast<WbSetLink __VA_ARGS__*>(hook)))
+
+/// @brief Sequence of elements ordered only by their positions, rather than by keys.
+/// The elements are linked into the same weight balanced tree as @ref WbSet, whose subtree
+/// weights allow accessing, inserting and removing elements by index in O(log n) time.
+/// Sequences can be split and concatenated in O(log n) time.
+template<std::derived_from<WbSetLink> T>
+class WbSequence : Core
+{
+	using RootType = Hook*;
+
+public:
+	using ElementType = T;
+
+	using       iterator = Iterator<      T>;
+	using const_iterator = Iterator<const T>;
+
+
+	WbSequence() = default;
+
+	WbSequence(WbSequence&& src) noexcept
+		: Core(static_cast<Core&&>(src))
+	{
+		AttachRoot();
+	}
+
+	WbSequence& operator=(WbSequence&& src) noexcept
+	{
+		if (m_root.Value != nullptr)
+			Core::Clear();
+		Core::operator=(static_cast<Core&&>(src));
+		AttachRoot();
+		return *this;
+	}
+
+	~WbSequence()
+	{
+		if (m_root.Value != nullptr)
+			Core::Clear();
+	}
+
+
+	/// @return Size of the sequence.
+	[[nodiscard]] size_t Size() const
+	{
+		return m_root.Value != nullptr ? m_root.Value->weight : 0;
+	}
+
+	/// @return True if the sequence is empty.
+	[[nodiscard]] bool IsEmpty() const
+	{
+		return m_root.Value == nullptr;
+	}
+
+
+	/// @param index Position of the element.
+	/// @return Element at the index.
+	/// @pre @p index is less than the size of the sequence.
+	[[nodiscard]] T* At(size_t const index)
+	{
+		Eco_Assert(index < Size());
+		return Eco_WB_ELEM(Core::Select(index));
+	}
+
+	/// @param index Position of the element.
+	/// @return Element at the index.
+	/// @pre @p index is less than the size of the sequence.
+	[[nodiscard]] const T* At(size_t const index) const
+	{
+		Eco_Assert(index < Size());
+		return Eco_WB_ELEM(Core::Select(index));
+	}
+
+	/// @param element Element of the sequence.
+	/// @return Position of the element.
+	/// @pre @p element is part of this sequence.
+	[[nodiscard]] size_t IndexOf(const T* const element) const
+	{
+		return Core::Rank(Eco_WB_HOOK(element, const));
+	}
+
+
+	/// @brief Insert new element into the sequence before the element at an index.
+	/// @param index Position of the new element.
+	/// @param element Element to be inserted.
+	/// @pre @p index is not greater than the size of the sequence.
+	/// @pre @p element is not part of any container.
+	void InsertAt(size_t const index, T* const element)
+	{
+		Core::InsertAt(index, Eco_WB_HOOK(element));
+	}
+
+	/// @brief Insert new element at the end of the sequence.
+	/// @param element Element to be inserted.
+	/// @pre @p element is not part of any container.
+	void Append(T* const element)
+	{
+		Core::InsertAt(Size(), Eco_WB_HOOK(element));
+	}
+
+	/// @brief Remove an element from the sequence.
+	/// @param element Element to be removed.
+	/// @pre @p element is part of this sequence.
+	void Remove(T* const element)
+	{
+		Core::Remove(Eco_WB_HOOK(element));
+	}
+
+	/// @brief Remove the element at an index from the sequence.
+	/// @param index Position of the element.
+	/// @return The removed element.
+	/// @pre @p index is less than the size of the sequence.
+	T* RemoveAt(size_t const index)
+	{
+		Eco_Assert(index < Size());
+		Hook* const hook = Core::Select(index);
+		Core::Remove(hook);
+		return Eco_WB_ELEM(hook);
+	}
+
+	/// @brief Remove all elements from the sequence.
+	using Core::Clear;
+
+
+	/// @brief Split the sequence at an index in O(log n) time.
+	/// @param index Position of the first element moved to the new sequence.
+	/// @return Sequence containing the elements at and after the index.
+	/// @pre @p index is not greater than the size of the sequence.
+	[[nodiscard]] WbSequence SplitAt(size_t const index)
+	{
+		WbSequence other;
+		Core::SplitAt(index, other);
+		return other;
+	}
+
+	/// @brief Move all elements of another sequence to the end of this sequence in O(log n) time.
+	/// @param other Sequence whose elements are appended.
+	void Concat(WbSequence& other)
+	{
+		Eco_Assert(&other != this);
+		Core::Concat(other);
+	}
+
+
+	[[nodiscard]] iterator begin()
+	{
+		return iterator(IteratorBegin(&m_root.Value));
+	}
+
+	[[nodiscard]] const_iterator begin() const
+	{
+		return const_iterator(IteratorBegin(const_cast<RootType*>(&m_root.Value)));
+	}
+
+	[[nodiscard]] iterator end()
+	{
+		return iterator(&m_root.Value);
+	}
+
+	[[nodiscard]] const_iterator end() const
+	{
+		return const_iterator(const_cast<RootType*>(&m_root.Value));
+	}
+
+
+	[[nodiscard]] friend size_t size(const WbSequence& sequence)
+	{
+		return sequence.Size();
+	}
+
+private:
+	// The root hook refers back to m_root, which must be updated after moving.
+	void AttachRoot()
+	{
+		if (m_root.Value != nullptr)
+			m_root.Value->parent = &m_root.Value;
+	}
+};
+
+#undef Eco_WB_HOOK
+#undef Eco_WB_ELEM
+
+} // namespace Private::WbSet_
+
+using Private::WbSet_::WbSequence;
+
+// } // inline namespace Eco_NS
+} // namespace Eco
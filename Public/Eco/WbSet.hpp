@@ -3,15 +3,24 @@
 #define Eco_WB_DEBUG 0
 
 #include "Eco/Attributes.hpp"
+#include "Eco/Executor.hpp"
 #include "Eco/InsertResult.hpp"
+#include "Eco/KeyPrefix.hpp"
 #include "Eco/KeySelector.hpp"
 #include "Eco/Linear.hpp"
 #include "Eco/Link.hpp"
 #include "Eco/List.hpp"
+#include "Eco/Private/Config.hpp"
 #include "Eco/TaggedPointer.hpp"
 
+#include <algorithm>
 #include <concepts>
+#include <random>
 #include <ranges>
+#include <span>
+
+#include <cmath>
+#include <cstdint>
 
 #if Eco_WB_DEBUG
 #	include <format>
@@ -22,6 +31,9 @@ namespace Eco {
 
 using WbSetLink = Link<4>;
 
+/// @brief Link required by @ref WbSet when caching key prefixes.
+using WbSetKeyPrefixLink = Link<4 + Private::KeyPrefixLinkSize>;
+
 namespace Private::WbSet_ {
 
 #define Eco_WB_HOOK(elem, ...) \
@@ -51,6 +63,14 @@ struct HookContent
 
 struct Hook : LinkBase, HookContent {};
 
+// Hook followed by the cached prefix of the key of its element.
+struct KeyPrefixHook : Hook
+{
+	KeyPrefixStorage prefix;
+};
+
+static_assert(sizeof(KeyPrefixHook) == sizeof(WbSetKeyPrefixLink));
+
 
 struct Core : LinkContainer
 {
@@ -70,9 +90,14 @@ struct Core : LinkContainer
 	size_t Rank(const Hook* hook) const;
 
 	void Insert(Hook* hook, Ptr<Hook*> parentAndSide);
+	void InsertAt(size_t index, Hook* hook);
 	void Remove(Hook* hook);
+	void Relocate(Hook* hook, Hook* newHook);
 	void Clear();
 	List_::Hook* Flatten();
+	List_::Hook* RemoveRange(Hook** first, Hook** last, Core& other, size_t& size);
+	void SplitAt(size_t index, Core& other);
+	void Concat(Core& other);
 
 	friend void swap(Core& lhs, Core& rhs) noexcept;
 };
@@ -166,14 +191,153 @@ struct WbSetChildren
 	}
 };
 
+// Draws a number of distinct ranks uniformly at random from [0, size) in increasing order,
+// in O(count) expected time, using Vitter's Algorithm D with Algorithm A for dense samples.
+template<typename TRandom>
+class RankSampler
+{
+	// The dense threshold of Algorithm D, above which the skips are drawn by Algorithm A.
+	static constexpr size_t DenseRatio = 13;
+
+	TRandom& m_random;
+
+	// Number of ranks still to be drawn.
+	size_t m_count;
+
+	// Number of ranks not yet skipped or drawn, starting at m_next.
+	size_t m_size;
+	size_t m_next = 0;
+
+public:
+	RankSampler(TRandom& random, size_t const count, size_t const size)
+		: m_random(random)
+		, m_count(count)
+		, m_size(size)
+	{
+		Eco_Assert(count <= size);
+	}
+
+	// Returns the next rank, or SIZE_MAX once all ranks have been drawn.
+	size_t Next()
+	{
+		if (m_count == 0) return SIZE_MAX;
+
+		size_t skip;
+		if (m_count == 1)
+			skip = std::min(static_cast<size_t>(static_cast<double>(m_size) * Uniform()), m_size - 1);
+		else if (m_size / DenseRatio > m_count)
+			skip = SkipSparse();
+		else
+			skip = SkipDense();
+
+		size_t const rank = m_next + skip;
+		m_next = rank + 1;
+		m_size -= skip + 1;
+		--m_count;
+		return rank;
+	}
+
+private:
+	double Uniform()
+	{
+		return std::uniform_real_distribution<double>()(m_random);
+	}
+
+	// Algorithm A: walk the skip distribution in O(skip) time.
+	size_t SkipDense()
+	{
+		double const v = Uniform();
+
+		double top = static_cast<double>(m_size - m_count);
+		double size = static_cast<double>(m_size);
+
+		size_t skip = 0;
+		for (double quotient = top / size; quotient > v; quotient *= top / size)
+		{
+			++skip;
+			top -= 1;
+			size -= 1;
+		}
+		return skip;
+	}
+
+	// Algorithm D: draw the skip by rejection from a continuous approximation in O(1) expected time.
+	size_t SkipSparse()
+	{
+		double const n = static_cast<double>(m_count);
+		double const size = static_cast<double>(m_size);
+		double const nInverse = 1 / n;
+		double const nMinus1Inverse = 1 / (n - 1);
+
+		// Number of possible skips.
+		size_t const limit = m_size - m_count + 1;
+		double const limitReal = static_cast<double>(limit);
+
+		double vPrime = std::exp(std::log(Uniform()) * nInverse);
+		while (true)
+		{
+			double x;
+			size_t skip;
+			while (true)
+			{
+				x = size * (1 - vPrime);
+				skip = static_cast<size_t>(x);
+				if (skip < limit) break;
+				vPrime = std::exp(std::log(Uniform()) * nInverse);
+			}
+
+			double const y1 = std::exp(std::log(Uniform() * size / limitReal) * nMinus1Inverse);
+			vPrime = y1 * (1 - x / size) * (limitReal / (limitReal - static_cast<double>(skip)));
+			if (vPrime <= 1) return skip;
+
+			// Compute the exact ratio of the probabilities for the rejection test.
+			double y2 = 1;
+			double top = size - 1;
+			double bottom;
+			size_t end;
+			if (m_count - 1 > skip)
+			{
+				bottom = size - n;
+				end = m_size - skip;
+			}
+			else
+			{
+				bottom = size - static_cast<double>(skip) - 1;
+				end = limit;
+			}
+
+			for (size_t t = m_size - 1; t >= end; --t)
+			{
+				y2 = y2 * top / bottom;
+				top -= 1;
+				bottom -= 1;
+			}
+
+			if (size / (size - x) >= y1 * std::exp(std::log(y2) * nMinus1Inverse))
+				return skip;
+
+			vPrime = std::exp(std::log(Uniform()) * nInverse);
+		}
+	}
+};
+
 template<std::derived_from<WbSetLink> T,
 	KeySelector<T> TKeySelector = IdentityKeySelector,
-	typename TComparator = std::compare_three_way>
+	typename TComparator = std::compare_three_way,
+	KeyPrefixPolicy<std::remove_cvref_t<decltype(std::declval<const TKeySelector&>()(std::declval<const T&>()))>> TKeyPrefix = NoKeyPrefix>
+	requires std::is_same_v<TKeyPrefix, NoKeyPrefix> || std::derived_from<T, WbSetKeyPrefixLink>
 class WbSet : Core
 {
 	using KeyType = decltype(std::declval<const TKeySelector&>()(std::declval<const T&>()));
 	using RootType = Hook*;
 
+	static constexpr bool HasKeyPrefix = !std::is_same_v<TKeyPrefix, NoKeyPrefix>;
+
+	// Heterogeneous keys not accepted by the key prefix policy are compared without prefixes.
+	template<typename TKey>
+	static constexpr bool UsesKeyPrefix = HasKeyPrefix &&
+		requires (const TKey& key) { TKeyPrefix::Prefix(key); };
+
 	Eco_NO_UNIQUE_ADDRESS TKeySelector m_keySelector;
 	Eco_NO_UNIQUE_ADDRESS TComparator m_comparator;
 
@@ -189,6 +353,31 @@ public:
 
 	using InsertResult = Eco::InsertResult<T>;
 
+	/// @brief Opaque position in the tree at which a new element may be inserted.
+	class InsertPosition
+	{
+		Ptr<Hook*> m_parent;
+
+		explicit InsertPosition(Ptr<Hook*> const parent)
+			: m_parent(parent)
+		{
+		}
+
+		friend WbSet;
+
+	public:
+		InsertPosition() = default;
+	};
+
+	struct PrepareResult
+	{
+		/// @brief Matching element in the container, or null if there is none.
+		T* Element;
+
+		/// @brief Position at which an element with the key may be inserted if there is no match.
+		InsertPosition Position;
+	};
+
 
 #if Eco_WB_DEBUG
 	WbSet()
@@ -289,7 +478,85 @@ public:
 
 	[[nodiscard]] size_t Rank(const T* const element) const
 	{
-		return Core::Rank(Eco_WB_HOOK(element));
+		return Core::Rank(Eco_WB_HOOK(element, const));
+	}
+
+	/// @brief Select an element uniformly at random in O(log n) time.
+	/// @param random Uniform random bit generator.
+	/// @pre The set is not empty.
+	template<std::uniform_random_bit_generator TRandom>
+	[[nodiscard]] T* SampleUniform(TRandom& random)
+	{
+		return Eco_WB_ELEM(Core::Select(SampleRank(random)));
+	}
+
+	/// @brief Select an element uniformly at random in O(log n) time.
+	/// @param random Uniform random bit generator.
+	/// @pre The set is not empty.
+	template<std::uniform_random_bit_generator TRandom>
+	[[nodiscard]] const T* SampleUniform(TRandom& random) const
+	{
+		return Eco_WB_ELEM(Core::Select(SampleRank(random)));
+	}
+
+	/// @brief Select distinct elements uniformly at random.
+	/// The ranks are drawn in increasing order using Vitter's Algorithm D, and the elements
+	/// are selected as the ranks are drawn in a single combined descent which visits shared
+	/// ancestors only once. This takes O(k + k log(n / k)) expected time without allocating.
+	/// @param elements Receives the sampled elements in order. Its size is the number of samples.
+	/// @param random Uniform random bit generator.
+	/// @pre @p elements is not larger than the set.
+	template<std::uniform_random_bit_generator TRandom>
+	void SampleK(std::span<T*> const elements, TRandom& random)
+	{
+		SampleKInternal(elements, random);
+	}
+
+	/// @brief Select distinct elements uniformly at random.
+	/// @param elements Receives the sampled elements in order. Its size is the number of samples.
+	/// @param random Uniform random bit generator.
+	/// @pre @p elements is not larger than the set.
+	template<std::uniform_random_bit_generator TRandom>
+	void SampleK(std::span<const T*> const elements, TRandom& random) const
+	{
+		SampleKInternal(elements, random);
+	}
+
+	/// @brief Count the elements whose keys are ordered before a key in O(log n) time.
+	/// @param key Lookup key, which need not be present in the set.
+	/// @return Rank of the element with the key if present, or otherwise the rank it would have.
+	[[nodiscard]] size_t RankOfKey(const KeyType& key) const
+	{
+		return RankInternal(key);
+	}
+
+	/// @brief Count the elements whose keys are ordered before a heterogeneous key in O(log n) time.
+	/// @param key Lookup key, which need not be present in the set.
+	template<typename TKey>
+	[[nodiscard]] size_t RankOfKeyEquivalent(const TKey& key) const
+		requires (requires (const KeyType& containerKey) { m_comparator(key, containerKey); })
+	{
+		return RankInternal(key);
+	}
+
+	/// @brief Count the elements with keys in the half-open interval [lo, hi) in O(log n) time.
+	/// @param lo Inclusive lower bound.
+	/// @param hi Exclusive upper bound.
+	/// @pre @p lo is not ordered after @p hi.
+	[[nodiscard]] size_t CountRange(const KeyType& lo, const KeyType& hi) const
+	{
+		return CountRangeInternal(lo, hi);
+	}
+
+	/// @brief Count the elements with keys in the half-open interval [lo, hi) of heterogeneous keys.
+	/// @param lo Inclusive lower bound.
+	/// @param hi Exclusive upper bound.
+	/// @pre @p lo is not ordered after @p hi.
+	template<typename TKey>
+	[[nodiscard]] size_t CountRangeEquivalent(const TKey& lo, const TKey& hi) const
+		requires (requires (const KeyType& containerKey) { m_comparator(lo, containerKey); })
+	{
+		return CountRangeInternal(lo, hi);
 	}
 
 
@@ -317,20 +584,235 @@ public:
 		return Eco_WB_ELEM(FindInternal(key).hook);
 	}
 
+	/// @brief Find elements by multiple homogeneous keys.
+	/// The searches are advanced in an interleaved manner, prefetching the next hook of
+	/// each search, so that the cache misses of independent searches overlap.
+	/// @param keys Lookup keys.
+	/// @param elements Receives a pointer to the element for each key, or null if not found.
+	/// @pre @p elements is at least as large as @p keys.
+	void FindBatch(std::span<const std::remove_cvref_t<KeyType>> const keys, std::span<T*> const elements)
+	{
+		FindBatchInternal(keys, elements);
+	}
+
+	/// @brief Find elements by multiple homogeneous keys.
+	/// The searches are advanced in an interleaved manner, prefetching the next hook of
+	/// each search, so that the cache misses of independent searches overlap.
+	/// @param keys Lookup keys.
+	/// @param elements Receives a pointer to the element for each key, or null if not found.
+	/// @pre @p elements is at least as large as @p keys.
+	void FindBatch(std::span<const std::remove_cvref_t<KeyType>> const keys, std::span<const T*> const elements) const
+	{
+		FindBatchInternal(keys, elements);
+	}
+
+	/// @brief Find the first element whose key is not ordered before a key.
+	/// @param key Lookup key.
+	/// @return Iterator referring to the element, or the end iterator.
+	[[nodiscard]] iterator LowerBound(const KeyType& key)
+	{
+		return iterator(BoundInternal(key, false));
+	}
+
+	/// @brief Find the first element whose key is not ordered before a key.
+	/// @param key Lookup key.
+	/// @return Iterator referring to the element, or the end iterator.
+	[[nodiscard]] const_iterator LowerBound(const KeyType& key) const
+	{
+		return const_iterator(BoundInternal(key, false));
+	}
+
+	/// @brief Find the first element whose key is not ordered before a heterogeneous key.
+	/// @param key Lookup key.
+	/// @return Iterator referring to the element, or the end iterator.
+	template<typename TKey>
+	[[nodiscard]] iterator LowerBoundEquivalent(const TKey& key)
+		requires (requires (const KeyType& containerKey) { m_comparator(key, containerKey); })
+	{
+		return iterator(BoundInternal(key, false));
+	}
+
+	/// @brief Find the first element whose key is not ordered before a heterogeneous key.
+	/// @param key Lookup key.
+	/// @return Iterator referring to the element, or the end iterator.
+	template<typename TKey>
+	[[nodiscard]] const_iterator LowerBoundEquivalent(const TKey& key) const
+		requires (requires (const KeyType& containerKey) { m_comparator(key, containerKey); })
+	{
+		return const_iterator(BoundInternal(key, false));
+	}
+
+	/// @brief Find the first element whose key is ordered after a key.
+	/// @param key Lookup key.
+	/// @return Iterator referring to the element, or the end iterator.
+	[[nodiscard]] iterator UpperBound(const KeyType& key)
+	{
+		return iterator(BoundInternal(key, true));
+	}
+
+	/// @brief Find the first element whose key is ordered after a key.
+	/// @param key Lookup key.
+	/// @return Iterator referring to the element, or the end iterator.
+	[[nodiscard]] const_iterator UpperBound(const KeyType& key) const
+	{
+		return const_iterator(BoundInternal(key, true));
+	}
+
+	/// @brief Find the first element whose key is ordered after a heterogeneous key.
+	/// @param key Lookup key.
+	/// @return Iterator referring to the element, or the end iterator.
+	template<typename TKey>
+	[[nodiscard]] iterator UpperBoundEquivalent(const TKey& key)
+		requires (requires (const KeyType& containerKey) { m_comparator(key, containerKey); })
+	{
+		return iterator(BoundInternal(key, true));
+	}
+
+	/// @brief Find the first element whose key is ordered after a heterogeneous key.
+	/// @param key Lookup key.
+	/// @return Iterator referring to the element, or the end iterator.
+	template<typename TKey>
+	[[nodiscard]] const_iterator UpperBoundEquivalent(const TKey& key) const
+		requires (requires (const KeyType& containerKey) { m_comparator(key, containerKey); })
+	{
+		return const_iterator(BoundInternal(key, true));
+	}
+
+	/// @brief Find the range of elements with keys equivalent to a key.
+	/// @param key Lookup key.
+	/// @return Range containing the matching element, or an empty range at its lower bound.
+	[[nodiscard]] std::ranges::subrange<iterator> EqualRange(const KeyType& key)
+	{
+		return { iterator(BoundInternal(key, false)), iterator(BoundInternal(key, true)) };
+	}
+
+	/// @brief Find the range of elements with keys equivalent to a key.
+	/// @param key Lookup key.
+	/// @return Range containing the matching element, or an empty range at its lower bound.
+	[[nodiscard]] std::ranges::subrange<const_iterator> EqualRange(const KeyType& key) const
+	{
+		return { const_iterator(BoundInternal(key, false)), const_iterator(BoundInternal(key, true)) };
+	}
+
+	/// @brief Find the range of elements with keys equivalent to a heterogeneous key.
+	/// @param key Lookup key.
+	/// @return Range of the matching elements, or an empty range at their lower bound.
+	template<typename TKey>
+	[[nodiscard]] std::ranges::subrange<iterator> EqualRangeEquivalent(const TKey& key)
+		requires (requires (const KeyType& containerKey) { m_comparator(key, containerKey); })
+	{
+		return { iterator(BoundInternal(key, false)), iterator(BoundInternal(key, true)) };
+	}
+
+	/// @brief Find the range of elements with keys equivalent to a heterogeneous key.
+	/// @param key Lookup key.
+	/// @return Range of the matching elements, or an empty range at their lower bound.
+	template<typename TKey>
+	[[nodiscard]] std::ranges::subrange<const_iterator> EqualRangeEquivalent(const TKey& key) const
+		requires (requires (const KeyType& containerKey) { m_comparator(key, containerKey); })
+	{
+		return { const_iterator(BoundInternal(key, false)), const_iterator(BoundInternal(key, true)) };
+	}
+
+	/// @brief Create a view of the elements with keys in the half-open interval [lo, hi).
+	/// @param lo Inclusive lower bound.
+	/// @param hi Exclusive upper bound.
+	/// @pre @p lo is not ordered after @p hi.
+	[[nodiscard]] std::ranges::subrange<iterator> Range(const KeyType& lo, const KeyType& hi)
+	{
+		return { iterator(BoundInternal(lo, false)), iterator(BoundInternal(hi, false)) };
+	}
+
+	/// @brief Create a view of the elements with keys in the half-open interval [lo, hi).
+	/// @param lo Inclusive lower bound.
+	/// @param hi Exclusive upper bound.
+	/// @pre @p lo is not ordered after @p hi.
+	[[nodiscard]] std::ranges::subrange<const_iterator> Range(const KeyType& lo, const KeyType& hi) const
+	{
+		return { const_iterator(BoundInternal(lo, false)), const_iterator(BoundInternal(hi, false)) };
+	}
+
+	/// @brief Create a view of the elements with keys in the half-open interval [lo, hi) of heterogeneous keys.
+	/// @param lo Inclusive lower bound.
+	/// @param hi Exclusive upper bound.
+	/// @pre @p lo is not ordered after @p hi.
+	template<typename TKey>
+	[[nodiscard]] std::ranges::subrange<iterator> RangeEquivalent(const TKey& lo, const TKey& hi)
+		requires (requires (const KeyType& containerKey) { m_comparator(lo, containerKey); })
+	{
+		return { iterator(BoundInternal(lo, false)), iterator(BoundInternal(hi, false)) };
+	}
+
+	/// @brief Create a view of the elements with keys in the half-open interval [lo, hi) of heterogeneous keys.
+	/// @param lo Inclusive lower bound.
+	/// @param hi Exclusive upper bound.
+	/// @pre @p lo is not ordered after @p hi.
+	template<typename TKey>
+	[[nodiscard]] std::ranges::subrange<const_iterator> RangeEquivalent(const TKey& lo, const TKey& hi) const
+		requires (requires (const KeyType& containerKey) { m_comparator(lo, containerKey); })
+	{
+		return { const_iterator(BoundInternal(lo, false)), const_iterator(BoundInternal(hi, false)) };
+	}
+
 
 	InsertResult Insert(T* const element)
 	{
 		auto const r = FindInternal(m_keySelector(*element));
 		if (r.hook != nullptr) return { Eco_WB_ELEM(r.hook), false };
+		StoreKeyPrefix(element);
 		Core::Insert(Eco_WB_HOOK(element), r.parent);
 		return { element, true };
 	}
 
+	/// @brief Find element by homogeneous key, or the position at which it would be inserted.
+	/// @param key Lookup key.
+	/// @return Matching element, or null and the insert position for use with @ref InsertAt.
+	/// @note This allows constructing a new element only if the key is not found.
+	[[nodiscard]] PrepareResult FindOrPrepare(const KeyType& key)
+	{
+		return FindOrPrepareInternal(key);
+	}
+
+	/// @brief Find element by heterogeneous key, or the position at which it would be inserted.
+	/// @param key Lookup key.
+	/// @return Matching element, or null and the insert position for use with @ref InsertAt.
+	/// @note This allows constructing a new element only if the key is not found.
+	template<typename TKey>
+	[[nodiscard]] PrepareResult FindOrPrepareEquivalent(const TKey& key)
+		requires (requires (const KeyType& containerKey) { m_comparator(key, containerKey); })
+	{
+		return FindOrPrepareInternal(key);
+	}
+
+	/// @brief Insert new element at a position returned by @ref FindOrPrepare without searching.
+	/// @param position Insert position returned for a key not found in the set.
+	/// @param element Element to be inserted.
+	/// @pre @p element is not part of any container.
+	/// @pre The key of @p element is equivalent to the key passed to @ref FindOrPrepare.
+	/// @pre The set has not been modified since the call to @ref FindOrPrepare.
+	void InsertAt(InsertPosition const position, T* const element)
+	{
+		Eco_Assert(position.m_parent.Ptr()[position.m_parent.Tag()] == nullptr);
+		StoreKeyPrefix(element);
+		Core::Insert(Eco_WB_HOOK(element), position.m_parent);
+	}
+
 	void Remove(T* const element)
 	{
 		Core::Remove(Eco_WB_HOOK(element));
 	}
 
+	/// @brief Replace an element by a copy at a new address, such as after moving it in memory.
+	/// The links referring to the element are redirected to the copy in constant time.
+	/// @param element Element to be replaced.
+	/// @param newElement Bitwise copy of @p element, which takes its place in the tree.
+	/// @pre @p element is part of this tree.
+	/// @note Iterators referring to @p element are invalidated.
+	void Relocate(T* const element, T* const newElement)
+	{
+		Core::Relocate(Eco_WB_HOOK(element), Eco_WB_HOOK(newElement));
+	}
+
 	/// @brief Remove all elements from the tree.
 	using Core::Clear;
 
@@ -341,6 +823,30 @@ public:
 		return List<T>(static_cast<LinkContainer&&>(*this), Core::Flatten(), size);
 	}
 
+	/// @brief Remove the elements with keys in the half-open interval [lo, hi).
+	/// @param lo Inclusive lower bound.
+	/// @param hi Exclusive upper bound.
+	/// @return List of the removed elements in order.
+	/// @pre @p lo is not ordered after @p hi.
+	/// @note The range is detached by splitting and joining the tree in logarithmic time,
+	///       after which the removed elements are linked into the list in linear time.
+	[[nodiscard]] List<T> RemoveRange(const KeyType& lo, const KeyType& hi)
+	{
+		return RemoveRangeInternal(lo, hi);
+	}
+
+	/// @brief Remove the elements with keys in the half-open interval [lo, hi) of heterogeneous keys.
+	/// @param lo Inclusive lower bound.
+	/// @param hi Exclusive upper bound.
+	/// @return List of the removed elements in order.
+	/// @pre @p lo is not ordered after @p hi.
+	template<typename TKey>
+	[[nodiscard]] List<T> RemoveRangeEquivalent(const TKey& lo, const TKey& hi)
+		requires (requires (const KeyType& containerKey) { m_comparator(lo, containerKey); })
+	{
+		return RemoveRangeInternal(lo, hi);
+	}
+
 
 	[[nodiscard]] iterator MakeIterator(T* const element)
 	{
@@ -355,6 +861,47 @@ public:
 	}
 
 
+	/// @brief Divide the set into contiguous ranges of equal size in O(P log n) time,
+	/// where P is the number of ranges.
+	/// The sizes of the ranges differ by at most one regardless of the distribution of the keys.
+	/// @param ranges Receives the ranges in order. Ranges may be empty if there are fewer elements.
+	void Partition(std::span<std::ranges::subrange<iterator>> const ranges)
+	{
+		PartitionInternal(ranges);
+	}
+
+	/// @brief Divide the set into contiguous ranges of equal size in O(P log n) time,
+	/// where P is the number of ranges.
+	/// @param ranges Receives the ranges in order. Ranges may be empty if there are fewer elements.
+	void Partition(std::span<std::ranges::subrange<const_iterator>> const ranges) const
+	{
+		PartitionInternal(ranges);
+	}
+
+	/// @brief Invoke a function for each element in parallel.
+	/// The set is partitioned into ranges of equal size, each of which is visited in order by a single task.
+	/// @param executor Executor used to visit the ranges in parallel.
+	/// @param function Function invoked with a reference to each element.
+	/// @note The function is invoked concurrently for elements in different ranges.
+	/// @note The function must not modify the set.
+	template<Executor TExecutor, typename TFunction>
+	void ParallelForEach(TExecutor&& executor, TFunction&& function)
+		requires std::invocable<TFunction&, T&>
+	{
+		ParallelForEachInternal<iterator>(ExecutorRef(executor), function);
+	}
+
+	/// @brief Invoke a function for each element in parallel.
+	/// @param executor Executor used to visit the ranges in parallel.
+	/// @param function Function invoked with a reference to each element.
+	template<Executor TExecutor, typename TFunction>
+	void ParallelForEach(TExecutor&& executor, TFunction&& function) const
+		requires std::invocable<TFunction&, const T&>
+	{
+		ParallelForEachInternal<const_iterator>(ExecutorRef(executor), function);
+	}
+
+
 	[[nodiscard]] iterator begin()
 	{
 		return iterator(IteratorBegin(&m_root.Value));
@@ -425,17 +972,144 @@ public:
 #endif
 
 private:
+	void StoreKeyPrefix([[maybe_unused]] T* const element) const
+	{
+		if constexpr (HasKeyPrefix)
+		{
+			static_cast<KeyPrefixHook*>(Eco_WB_HOOK(element))->prefix.Store(
+				TKeyPrefix::Prefix(m_keySelector(const_cast<const T&>(*element))));
+		}
+	}
+
+	template<typename TKey>
+	static uint64_t KeyPrefix(const TKey& key)
+	{
+		if constexpr (UsesKeyPrefix<TKey>)
+		{
+			return TKeyPrefix::Prefix(key);
+		}
+		else
+		{
+			return 0;
+		}
+	}
+
+	// Compare a key with the key of a hook, first comparing the cached prefixes if possible.
+	template<typename TKey>
+	auto CompareKey(const TKey& key, [[maybe_unused]] uint64_t const prefix, Hook* const hook) const
+	{
+		if constexpr (UsesKeyPrefix<TKey>)
+		{
+			uint64_t const hookPrefix = static_cast<KeyPrefixHook*>(hook)->prefix.Load();
+			if (prefix != hookPrefix) return prefix < hookPrefix ? -1 : 1;
+
+			auto const ordering = m_comparator(key, m_keySelector(*Eco_WB_ELEM(hook)));
+			return (ordering > 0) - (ordering < 0);
+		}
+		else
+		{
+			return m_comparator(key, m_keySelector(*Eco_WB_ELEM(hook)));
+		}
+	}
+
+	// Find the first hook whose key is ordered after the key, or equivalent to it unless upper.
+	// Returns the children of the hook, or the root pointer if there is none.
+	template<typename TKey>
+	RootType* BoundInternal(const TKey& key, bool const upper) const
+	{
+		RootType* bound = const_cast<RootType*>(&m_root.Value);
+		Hook* hook = m_root.Value;
+
+		uint64_t const prefix = KeyPrefix(key);
+		while (hook != nullptr)
+		{
+			auto const ordering = CompareKey(key, prefix, hook);
+			if (ordering == 0 && !upper) return hook->children;
+
+			bool const r = ordering >= 0;
+			if (!r) bound = hook->children;
+			hook = hook->children[r];
+		}
+
+		return bound;
+	}
+
+	template<typename TElement>
+	void FindBatchInternal(std::span<const std::remove_cvref_t<KeyType>> const keys, std::span<TElement*> const elements) const
+	{
+		Eco_Assert(elements.size() >= keys.size());
+
+		// Number of searches in flight at a time.
+		static constexpr size_t GroupSize = 16;
+
+		Hook* const root = m_root.Value;
+
+		Hook* hooks[GroupSize];
+		size_t indices[GroupSize];
+		uint64_t prefixes[GroupSize];
+
+		size_t next = 0;
+		size_t active = 0;
+
+		while (active < GroupSize && next < keys.size())
+		{
+			hooks[active] = root;
+			prefixes[active] = KeyPrefix(keys[next]);
+			indices[active++] = next++;
+		}
+
+		while (active != 0)
+		{
+			for (size_t i = 0; i < active;)
+			{
+				Hook* const hook = hooks[i];
+				size_t const index = indices[i];
+
+				if (hook != nullptr)
+				{
+					auto const ordering = CompareKey(keys[index], prefixes[i], hook);
+					if (ordering != 0)
+					{
+						Hook* const child = hook->children[ordering > 0];
+						Eco_PREFETCH(child);
+
+						hooks[i++] = child;
+						continue;
+					}
+				}
+
+				elements[index] = Eco_WB_ELEM(hook);
+
+				// Start the next search in place of the finished one.
+				if (next < keys.size())
+				{
+					hooks[i] = root;
+					prefixes[i] = KeyPrefix(keys[next]);
+					indices[i++] = next++;
+				}
+				else
+				{
+					--active;
+					hooks[i] = hooks[active];
+					prefixes[i] = prefixes[active];
+					indices[i] = indices[active];
+				}
+			}
+		}
+	}
+
 	template<typename TKey>
 	FindResult FindInternal(const TKey& key) const
 	{
 		Hook** parent = const_cast<Hook**>(&m_root.Value);
 		bool l = 0;
 
+		uint64_t const prefix = KeyPrefix(key);
 		while (parent[l] != nullptr)
 		{
 			Hook* const child = parent[l];
 
-			auto const ordering = m_comparator(key, m_keySelector(*Eco_WB_ELEM(child)));
+			auto const ordering = CompareKey(key, prefix, child);
 			if (ordering == 0) return { child, { parent, l } };
 
 			parent = child->children;
@@ -444,6 +1118,199 @@ private:
 
 		return FindResult{ nullptr, { parent, l } };
 	}
+
+	template<typename TKey>
+	List<T> RemoveRangeInternal(const TKey& lo, const TKey& hi)
+	{
+		Core removed;
+		size_t size;
+		List_::Hook* const list = Core::RemoveRange(BoundInternal(lo, false), BoundInternal(hi, false), removed, size);
+		return List<T>(static_cast<LinkContainer&&>(removed), list, size);
+	}
+
+	static size_t SubtreeWeight(const Hook* const hook)
+	{
+		return hook != nullptr ? hook->weight : 0;
+	}
+
+	template<typename TRandom>
+	size_t SampleRank(TRandom& random) const
+	{
+		Eco_Assert(!IsEmpty());
+		return std::uniform_int_distribution<size_t>(0, Size() - 1)(random);
+	}
+
+	template<typename TElement, typename TRandom>
+	void SampleKInternal(std::span<TElement*> const elements, TRandom& random) const
+	{
+		Eco_Assert(elements.size() <= Size());
+
+		RankSampler<TRandom> sampler(random, elements.size(), Size());
+
+		TElement** element = elements.data();
+		size_t rank = sampler.Next();
+		SelectSampledInternal(m_root.Value, 0, sampler, rank, element);
+	}
+
+	// Select the hooks of a subtree, whose first hook has the base rank, at the sampled ranks.
+	// The ranks are drawn in increasing order as they are needed, with the next one pending in rank.
+	template<typename TElement, typename TRandom>
+	static void SelectSampledInternal(Hook* hook, size_t base,
+		RankSampler<TRandom>& sampler, size_t& rank, TElement**& elements)
+	{
+		while (rank < base + SubtreeWeight(hook))
+		{
+			size_t const hookRank = base + SubtreeWeight(hook->children[0]);
+
+			if (rank < hookRank)
+				SelectSampledInternal(hook->children[0], base, sampler, rank, elements);
+
+			if (rank == hookRank)
+			{
+				*elements++ = Eco_WB_ELEM(hook);
+				rank = sampler.Next();
+			}
+
+			base = hookRank + 1;
+			hook = hook->children[1];
+		}
+	}
+
+	// Sum the weights of the subtrees left of the search path of the key.
+	template<typename TKey>
+	size_t RankInternal(const TKey& key) const
+	{
+		size_t rank = 0;
+		Hook* hook = m_root.Value;
+
+		uint64_t const prefix = KeyPrefix(key);
+		while (hook != nullptr)
+		{
+			auto const ordering = CompareKey(key, prefix, hook);
+			if (ordering == 0) return rank + SubtreeWeight(hook->children[0]);
+
+			if (ordering > 0)
+				rank += SubtreeWeight(hook->children[0]) + 1;
+
+			hook = hook->children[ordering > 0];
+		}
+
+		return rank;
+	}
+
+	// The search paths of the bounds are shared until they diverge,
+	// after which each bound only descends into its own subtree.
+	template<typename TKey>
+	size_t CountRangeInternal(const TKey& lo, const TKey& hi) const
+	{
+		Hook* hook = m_root.Value;
+
+		uint64_t const loPrefix = KeyPrefix(lo);
+		uint64_t const hiPrefix = KeyPrefix(hi);
+		while (hook != nullptr)
+		{
+			auto const loOrdering = CompareKey(lo, loPrefix, hook);
+			if (loOrdering > 0)
+			{
+				hook = hook->children[1];
+				continue;
+			}
+
+			auto const hiOrdering = CompareKey(hi, hiPrefix, hook);
+			if (hiOrdering <= 0)
+			{
+				hook = hook->children[0];
+				continue;
+			}
+
+			// The hook is within the range, which is split between its subtrees.
+			size_t count = 1;
+
+			// Count the elements of the left subtree not ordered before lo.
+			for (Hook* l = hook->children[0]; l != nullptr;)
+			{
+				auto const ordering = CompareKey(lo, loPrefix, l);
+				if (ordering <= 0)
+				{
+					count += SubtreeWeight(l->children[1]) + 1;
+					if (ordering == 0) break;
+				}
+				l = l->children[ordering > 0];
+			}
+
+			// Count the elements of the right subtree ordered before hi.
+			for (Hook* r = hook->children[1]; r != nullptr;)
+			{
+				auto const ordering = CompareKey(hi, hiPrefix, r);
+				if (ordering >= 0)
+				{
+					count += SubtreeWeight(r->children[0]);
+					if (ordering == 0) break;
+					++count;
+				}
+				r = r->children[ordering > 0];
+			}
+
+			return count;
+		}
+
+		return 0;
+	}
+
+	// Find the first hook of a range of a partition.
+	// Returns the children of the hook, or the root pointer if the range is at the end.
+	RootType* PartitionBound(size_t const index, size_t const count) const
+	{
+		size_t const size = Size();
+		size_t const rank = size / count * index + size % count * index / count;
+		return rank < size ? Core::Select(rank)->children : const_cast<RootType*>(&m_root.Value);
+	}
+
+	template<typename TIterator>
+	void PartitionInternal(std::span<std::ranges::subrange<TIterator>> const ranges) const
+	{
+		size_t const count = ranges.size();
+		if (count == 0) return;
+
+		TIterator first(PartitionBound(0, count));
+		for (size_t i = 0; i < count; ++i)
+		{
+			TIterator const last(PartitionBound(i + 1, count));
+			ranges[i] = { first, last };
+			first = last;
+		}
+	}
+
+	template<typename TIterator, typename TFunction>
+	void ParallelForEachInternal(ExecutorRef const& executor, TFunction& function) const
+	{
+		struct Context
+		{
+			const WbSet* set;
+			size_t count;
+			TFunction* function;
+		};
+
+		Context context = { this, std::min(executor.Concurrency(), Size()), &function };
+
+		// Each task finds the bounds of its own range.
+		executor.Run(context.count, [](void* const c, size_t const index)
+		{
+			Context& context = *static_cast<Context*>(c);
+
+			TIterator const last(context.set->PartitionBound(index + 1, context.count));
+			for (TIterator it(context.set->PartitionBound(index, context.count)); it != last; ++it)
+				(*context.function)(*it);
+		}, &context);
+	}
+
+	template<typename TKey>
+	PrepareResult FindOrPrepareInternal(const TKey& key)
+	{
+		auto const r = FindInternal(key);
+		if (r.hook != nullptr) return { Eco_WB_ELEM(r.hook), {} };
+		return { nullptr, InsertPosition(r.parent) };
+	}
 };
 
 #undef Eco_WB_HOOK